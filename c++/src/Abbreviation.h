@@ -0,0 +1,79 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string_view>
+#include <vector>
+#include <algorithm>
+#include "ObjectId.h"
+#include "ObjectDatabase.h"
+
+#ifndef GIT_CLONE_ABBREVIATION_H
+#define GIT_CLONE_ABBREVIATION_H
+
+namespace gitc {
+
+    // ids shortened to a prefix no other object shares, both ways: finding the objects a prefix can
+    // stand for, and the shortest prefixes of a list of ids
+    class Abbreviation {
+    public:
+        // ids are printed with at least as many digits, so they stay unique as objects are added
+        static constexpr size_t MIN_LENGTH = 7;
+        // shorter prefixes aren't resolved, they match too much of the database
+        static constexpr size_t MIN_RESOLVE_LENGTH = 4;
+
+        // the objects whose id starts with hex, sorted. empty if hex isn't a valid prefix
+        static std::vector<ObjectId> find(std::string_view hex, ObjectDatabase &db) {
+            std::vector<ObjectId> ids;
+            ObjectId prefix;
+            if (!ObjectId::from_hex_prefix(hex, prefix)) return ids;
+
+            db.find_prefix(prefix, hex.size(), ids);
+            sort_unique(ids);
+            return ids;
+        }
+
+        // the number of digits of each id that tell it apart from every other object. the objects are
+        // looked up once per fanout (first byte) the ids fall in, and sorted, so each id then only
+        // compares itself to its two neighbours
+        static std::vector<size_t> shortest_unique(const std::vector<ObjectId> &ids, ObjectDatabase &db) {
+            std::vector<ObjectId> objects;
+            bool seen[256] = {};
+
+            for (const ObjectId &id: ids) {
+                if (seen[id.bytes[0]]) continue;
+                seen[id.bytes[0]] = true;
+
+                ObjectId fanout;
+                fanout.bytes[0] = id.bytes[0];
+                db.find_prefix(fanout, 2, objects);
+            }
+            sort_unique(objects);
+
+            std::vector<size_t> lengths;
+            lengths.reserve(ids.size());
+
+            for (const ObjectId &id: ids) {
+                auto next = std::upper_bound(objects.begin(), objects.end(), id);
+                auto previous = std::lower_bound(objects.begin(), next, id);
+                size_t common = 0;
+
+                if (next != objects.end()) common = std::max(common, id.common_hex_digits(*next));
+                if (previous != objects.begin()) common = std::max(common, id.common_hex_digits(*(previous - 1)));
+
+                lengths.push_back(std::min(ObjectId::HEX_SIZE, std::max(MIN_LENGTH, common + 1)));
+            }
+
+            return lengths;
+        }
+
+    private:
+        static void sort_unique(std::vector<ObjectId> &ids) {
+            std::sort(ids.begin(), ids.end());
+            ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        }
+    };
+
+} // gitc
+
+#endif //GIT_CLONE_ABBREVIATION_H
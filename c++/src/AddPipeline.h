@@ -0,0 +1,114 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <algorithm>
+#include "Files.h"
+#include "ObjectDatabase.h"
+#include "Tree.h"
+#include "Blob.h"
+#include "Sha256Lanes.h"
+#include "BoundedQueue.h"
+#include "Ignore.h"
+#include "Pathspec.h"
+
+#ifndef GIT_CLONE_ADDPIPELINE_H
+#define GIT_CLONE_ADDPIPELINE_H
+
+namespace gitc {
+
+    // stores every file a pathspec matches as a pipeline of stages connected by bounded queues:
+    //   walker -> paths -> hashing workers (one per core) -> objects -> writer
+    // the walker lists files while the first ones are already being read and hashed, and the single
+    // writer is the only one to touch the object database. a slow disk stalls the hashing instead of piling
+    // up file contents: each worker holds less than MAX_BATCH_BYTES plus one file (or chunk) below
+    // CHUNKING_THRESHOLD, and the object queue OBJECT_QUEUE_SIZE objects of at most CHUNKING_THRESHOLD.
+    // with 5 MiB per worker and 128 MiB queued, 16 cores have at most 208 MiB in flight
+    class AddPipeline {
+    public:
+        struct Stored_file {
+            std::string path;
+            ObjectId hash;
+            Tree::Entry_type type;
+        };
+
+        // appends every file found to stored, in no particular order. the walk starts below the directory
+        // every pathspec is in, and never opens a directory that is ignored or can't match
+        static void store(const Pathspec &pathspec, std::vector<Stored_file> &stored) {
+            BoundedQueue<std::string> paths(PATH_QUEUE_SIZE);
+            BoundedQueue<Object> objects(OBJECT_QUEUE_SIZE);
+
+            std::thread walker([&paths, &pathspec]() {
+                const Ignore &ignore = Ignore::get();
+                Files::walk_files(pathspec.walk_root(), [&paths, &ignore, &pathspec](std::string &&file) {
+                    if (!ignore.is_ignored(file, false) && pathspec.matches(file)) paths.push(std::move(file));
+                }, [&ignore, &pathspec](const std::string &directory) {
+                    return !ignore.is_ignored(directory, true) && pathspec.may_match_below(directory);
+                });
+                paths.close();
+            });
+
+            const size_t number_of_workers = std::max(1u, std::thread::hardware_concurrency());
+            std::vector<std::vector<Stored_file>> results(number_of_workers);
+            std::vector<std::thread> workers;
+
+            for (size_t i = 0; i < number_of_workers; i++) {
+                workers.emplace_back([&paths, &objects, &result = results[i]]() {
+                    std::string files[BATCH_SIZE];
+                    ObjectId hashes[BATCH_SIZE];
+                    Tree::Entry_type types[BATCH_SIZE];
+
+                    // whatever is queued is taken in one batch, so small files are hashed side by side
+                    while (paths.pop(files[0])) {
+                        size_t count = 1;
+                        while (count < BATCH_SIZE && paths.try_pop(files[count])) count++;
+
+                        Blob::store_many(files, count, hashes, types, [&objects](const ObjectId &id, std::string &&content) {
+                            objects.push({id, std::move(content)});
+                        });
+
+                        for (size_t j = 0; j < count; j++) {
+                            result.push_back({std::move(files[j]), hashes[j], types[j]});
+                        }
+                    }
+                });
+            }
+
+            std::thread writer([&objects]() {
+                ObjectDatabase &db = ObjectDatabase::get();
+                Object object;
+                while (objects.pop(object)) {
+                    if (!db.freshen(object.id)) db.write(object.id, object.content);
+                }
+            });
+
+            walker.join();
+            for (std::thread &worker: workers) {
+                worker.join();
+            }
+            objects.close();
+            writer.join();
+
+            for (std::vector<Stored_file> &result: results) {
+                std::move(result.begin(), result.end(), std::back_inserter(stored));
+            }
+        }
+
+    private:
+        struct Object {
+            ObjectId id;
+            std::string content;
+        };
+
+        static const size_t PATH_QUEUE_SIZE = 1024;
+        static const size_t BATCH_SIZE = 2 * Sha256Lanes::LANES;
+        // every queued object is a file below the chunking threshold, or a chunk
+        static const size_t OBJECT_QUEUE_SIZE = 32;
+    };
+
+} // gitc
+
+#endif //GIT_CLONE_ADDPIPELINE_H
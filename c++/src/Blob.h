@@ -0,0 +1,201 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
+#include "Files.h"
+#include "ObjectDatabase.h"
+#include "Sha256.h"
+#include "Sha256Lanes.h"
+#include "FastCdc.h"
+#include "Tree.h"
+
+#ifndef GIT_CLONE_BLOB_H
+#define GIT_CLONE_BLOB_H
+
+namespace gitc {
+
+    // files larger than this are split into content-defined chunks
+    const uint64_t CHUNKING_THRESHOLD = 4 * 1024 * 1024;
+    // the small files Blob::store_many reads before it hashes them
+    const uint64_t MAX_BATCH_BYTES = 1024 * 1024;
+
+    // the contents of a file. small files are one blob object, larger ones (Tree::CHUNKED) are a manifest
+    // listing their FastCDC chunks, each its own object, so a new revision of a large file only adds the
+    // chunks that changed and the file is never held in memory as a whole
+    class Blob {
+    public:
+        // stores the file, only writing the objects that don't exist yet, and returns its id and type
+        static ObjectId store(const std::string &path, Tree::Entry_type &type) {
+            ObjectDatabase &db = ObjectDatabase::get();
+
+            return store(path, type, [&db](const ObjectId &id, std::string &&content) {
+                if (!db.freshen(id)) db.write(id, content);
+            });
+        }
+
+        // hashes the file and hands every object it is made of to write(const ObjectId &, std::string &&),
+        // the chunks before their manifest. nothing here touches the object database
+        template<typename Write>
+        static ObjectId store(const std::string &path, Tree::Entry_type &type, Write &&write) {
+            if (Files::file_size(path) <= CHUNKING_THRESHOLD) {
+                std::string content;
+                Files::read_file(path, content);
+
+                const ObjectId id = Sha256::hash(content);
+                write(id, std::move(content));
+
+                type = Tree::BLOB;
+                return id;
+            }
+
+            std::ifstream file(path, std::ios::binary);
+            std::string buffer(READ_SIZE + FastCdc::MAX_SIZE, '\0');
+            std::string manifest;
+            size_t start = 0, filled = 0;
+            bool end_of_file = false;
+            uint64_t total_size = 0;
+
+            append_int<uint64_t>(manifest, 0);
+
+            while (true) {
+                // every cut sees at least MAX_SIZE bytes, except at the end of the file
+                if (filled - start < FastCdc::MAX_SIZE && !end_of_file) {
+                    buffer.erase(0, start);
+                    filled -= start;
+                    start = 0;
+
+                    buffer.resize(filled + READ_SIZE);
+                    file.read(&buffer[filled], READ_SIZE);
+                    filled += (size_t) file.gcount();
+                    end_of_file = !file;
+                }
+
+                if (start == filled) break;
+
+                const unsigned char *data = reinterpret_cast<const unsigned char *>(buffer.data()) + start;
+                const size_t length = FastCdc::cut(data, filled - start);
+                std::string content(buffer, start, length);
+                const ObjectId chunk = Sha256::hash(content);
+                write(chunk, std::move(content));
+
+                manifest.append(reinterpret_cast<const char *>(chunk.bytes), ObjectId::SIZE);
+                append_int<uint32_t>(manifest, (uint32_t) length);
+                total_size += length;
+                start += length;
+            }
+
+            std::memcpy(&manifest[0], &total_size, sizeof total_size);
+
+            const ObjectId id = Sha256::hash(manifest);
+            write(id, std::move(manifest));
+
+            type = Tree::CHUNKED;
+            return id;
+        }
+
+        // stores several files like store does, hashing the ones below the chunking threshold side by side.
+        // they are hashed and handed to write as soon as MAX_BATCH_BYTES are read, so at most that much
+        // and one more file are held at a time, however many files there are
+        template<typename Write>
+        static void store_many(const std::string *paths, size_t count, ObjectId *ids, Tree::Entry_type *types,
+                               Write &&write) {
+            std::vector<std::string> contents;
+            std::vector<size_t> positions;
+            size_t batch_bytes = 0;
+
+            auto hash_batch = [&]() {
+                std::vector<std::string_view> inputs(contents.begin(), contents.end());
+                std::vector<ObjectId> small_ids(contents.size());
+                Sha256Lanes::hash_many(inputs.data(), inputs.size(), small_ids.data());
+
+                for (size_t i = 0; i < contents.size(); i++) {
+                    ids[positions[i]] = small_ids[i];
+                    write(small_ids[i], std::move(contents[i]));
+                }
+
+                contents.clear();
+                positions.clear();
+                batch_bytes = 0;
+            };
+
+            for (size_t i = 0; i < count; i++) {
+                if (Files::file_size(paths[i]) > CHUNKING_THRESHOLD) {
+                    ids[i] = store(paths[i], types[i], write);
+                    continue;
+                }
+
+                contents.emplace_back();
+                Files::read_file(paths[i], contents.back());
+                positions.push_back(i);
+                types[i] = Tree::BLOB;
+
+                batch_bytes += contents.back().size();
+                if (batch_bytes >= MAX_BATCH_BYTES) hash_batch();
+            }
+
+            if (!contents.empty()) hash_batch();
+        }
+
+        // the ids the files would be stored as, without storing anything
+        static void hash_many(const std::string *paths, size_t count, ObjectId *ids, Tree::Entry_type *types) {
+            store_many(paths, count, ids, types, [](const ObjectId &, std::string &&) {});
+        }
+
+        // the chunks of a manifest, in order
+        static bool read_chunks(const ObjectId &manifest_hash, std::vector<ObjectId> &chunks) {
+            std::string manifest;
+            if (!ObjectDatabase::get().read(manifest_hash, manifest) || manifest.size() < sizeof(uint64_t))
+                return false;
+
+            for (size_t pos = sizeof(uint64_t); pos + CHUNK_ENTRY_SIZE <= manifest.size(); pos += CHUNK_ENTRY_SIZE) {
+                ObjectId chunk;
+                std::memcpy(chunk.bytes, manifest.data() + pos, ObjectId::SIZE);
+                chunks.push_back(chunk);
+            }
+
+            return true;
+        }
+
+        // writes the file's contents to out, a chunked file one chunk at a time
+        static bool write_to(const ObjectId &hash, Tree::Entry_type type, std::ostream &out) {
+            std::vector<ObjectId> chunks;
+            std::string content;
+
+            if (type != Tree::CHUNKED) {
+                chunks.push_back(hash);
+            } else if (!read_chunks(hash, chunks)) {
+                return false;
+            }
+
+            for (const ObjectId &chunk: chunks) {
+                if (!ObjectDatabase::get().read(chunk, content)) return false;
+                out.write(content.data(), (std::streamsize) content.size());
+            }
+
+            return out.good();
+        }
+
+        static bool write_to_file(const ObjectId &hash, Tree::Entry_type type, const std::string &path) {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            return write_to(hash, type, file);
+        }
+
+    private:
+        static constexpr size_t READ_SIZE = 4 * 1024 * 1024;
+        static constexpr size_t CHUNK_ENTRY_SIZE = ObjectId::SIZE + sizeof(uint32_t);
+
+        template<typename T>
+        static void append_int(std::string &out, T value) {
+            out.append(reinterpret_cast<const char *>(&value), sizeof value);
+        }
+    };
+
+} // gitc
+
+#endif //GIT_CLONE_BLOB_H
@@ -0,0 +1,73 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <cstdint>
+
+#ifndef GIT_CLONE_BLOOMFILTER_H
+#define GIT_CLONE_BLOOMFILTER_H
+
+namespace gitc {
+
+    // a set of paths that can answer "definitely not in the set" without false negatives
+    class BloomFilter {
+    public:
+        static const int BITS_PER_ENTRY = 10;
+        static const int NUMBER_OF_HASHES = 7;
+
+        explicit BloomFilter(size_t number_of_entries)
+                : bits(((number_of_entries * BITS_PER_ENTRY + 63) / 64) * 8, '\0') {}
+
+        explicit BloomFilter(const std::string &_bits) : bits(_bits) {}
+
+        void add(const std::string &path) {
+            if (bits.empty()) return;
+
+            uint64_t hash = fnv1a(path);
+            for (int i = 0; i < NUMBER_OF_HASHES; i++) {
+                uint64_t bit = nth_bit(hash, i);
+                bits[bit / 8] = (char) (bits[bit / 8] | (1 << (bit % 8)));
+            }
+        }
+
+        bool maybe_contains(const std::string &path) const {
+            // an empty filter is the filter of an empty set
+            if (bits.empty()) return false;
+
+            uint64_t hash = fnv1a(path);
+            for (int i = 0; i < NUMBER_OF_HASHES; i++) {
+                uint64_t bit = nth_bit(hash, i);
+                if (!(bits[bit / 8] & (1 << (bit % 8)))) return false;
+            }
+
+            return true;
+        }
+
+        const std::string &get_bits() const {
+            return bits;
+        }
+
+    private:
+        std::string bits;
+
+        static uint64_t fnv1a(const std::string &path) {
+            uint64_t hash = 14695981039346656037ULL;
+            for (unsigned char ch: path) {
+                hash ^= ch;
+                hash *= 1099511628211ULL;
+            }
+            return hash;
+        }
+
+        // double hashing: h1 + i * h2, with h2 odd so the probes don't collapse onto one bit
+        uint64_t nth_bit(uint64_t hash, int i) const {
+            uint32_t h1 = (uint32_t) hash;
+            uint32_t h2 = (uint32_t) (hash >> 32) | 1;
+            return ((uint64_t) h1 + (uint64_t) i * h2) % (bits.size() * 8);
+        }
+    };
+
+} // gitc
+
+#endif //GIT_CLONE_BLOOMFILTER_H
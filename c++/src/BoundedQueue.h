@@ -0,0 +1,116 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <cstddef>
+
+#ifndef GIT_CLONE_BOUNDEDQUEUE_H
+#define GIT_CLONE_BOUNDEDQUEUE_H
+
+namespace gitc {
+
+    // a fixed size lock-free queue for any number of producers and consumers (Vyukov's bounded MPMC
+    // queue). every slot carries a sequence number telling whose turn it is, so a push or pop is one
+    // compare and swap on the shared position and never waits on a lock. a full queue makes producers
+    // wait, which is what bounds the memory of a pipeline to its slowest stage
+    template<typename T>
+    class BoundedQueue {
+    public:
+        // capacity is rounded up to a power of two
+        explicit BoundedQueue(size_t capacity) {
+            size_t size = 2;
+            while (size < capacity) size *= 2;
+
+            mask = size - 1;
+            slots.reset(new Slot[size]);
+            for (size_t i = 0; i < size; i++) {
+                slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        BoundedQueue(const BoundedQueue &) = delete;
+        BoundedQueue &operator=(const BoundedQueue &) = delete;
+
+        bool try_push(T &value) {
+            size_t position = tail.load(std::memory_order_relaxed);
+
+            while (true) {
+                Slot &slot = slots[position & mask];
+                const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                const long difference = (long) sequence - (long) position;
+
+                if (difference == 0) {
+                    if (tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        slot.value = std::move(value);
+                        slot.sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (difference < 0) {
+                    return false; // full
+                } else {
+                    position = tail.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        bool try_pop(T &value) {
+            size_t position = head.load(std::memory_order_relaxed);
+
+            while (true) {
+                Slot &slot = slots[position & mask];
+                const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+                const long difference = (long) sequence - (long) (position + 1);
+
+                if (difference == 0) {
+                    if (head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                        value = std::move(slot.value);
+                        slot.sequence.store(position + mask + 1, std::memory_order_release);
+                        return true;
+                    }
+                } else if (difference < 0) {
+                    return false; // empty
+                } else {
+                    position = head.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // waits while the queue is full
+        void push(T value) {
+            while (!try_push(value)) std::this_thread::yield();
+        }
+
+        // waits while the queue is empty, false once it is empty and closed
+        bool pop(T &value) {
+            while (!try_pop(value)) {
+                if (closed.load(std::memory_order_acquire)) return try_pop(value);
+                std::this_thread::yield();
+            }
+            return true;
+        }
+
+        // no more pushes will come, consumers stop once they took everything
+        void close() {
+            closed.store(true, std::memory_order_release);
+        }
+
+    private:
+        struct Slot {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        // the positions are written by different threads, keep them on separate cache lines
+        alignas(64) std::atomic<size_t> head{0};
+        alignas(64) std::atomic<size_t> tail{0};
+        alignas(64) std::atomic<bool> closed{false};
+        std::unique_ptr<Slot[]> slots;
+        size_t mask;
+    };
+
+} // gitc
+
+#endif //GIT_CLONE_BOUNDEDQUEUE_H
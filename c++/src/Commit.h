@@ -3,11 +3,20 @@
 //
 
 #include <string>
+#include <string_view>
+#include <charconv>
 #include <algorithm>
+#include <map>
+#include <vector>
+#include <cstring>
 #include <time.h>
 #include "Index.h"
 #include "Files.h"
 #include "Tree.h"
+#include "Blob.h"
+#include "SparseCheckout.h"
+#include "ObjectDatabase.h"
+#include "ObjectArena.h"
 
 #ifndef GIT_CLONE_COMMIT_H
 #define GIT_CLONE_COMMIT_H
@@ -16,41 +25,63 @@ namespace gitc {
 
     class Commit {
     public:
-        Commit(std::string _commit_hash) : commit_hash(_commit_hash) {
+        // the object is read into a buffer allocated from resource, which has to outlive the commit
+        explicit Commit(const ObjectId &_commit_hash,
+                        std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+                : commit_hash(_commit_hash), content(resource) {
             read_from_file();
         }
 
+        // the message points into the commit's buffer
+        Commit(const Commit &) = delete;
+        Commit &operator=(const Commit &) = delete;
 
-        ~Commit() {
-            write_to_file();
-        }
-
-        std::string get_commit_hash() {
+        ObjectId get_commit_hash() {
             return commit_hash;
         }
 
-        std::string get_parent_commit_hash() {
+        ObjectId get_parent_commit_hash() {
             return parent_hash;
         }
 
-        static Commit *create_commit_from_index(Index &index, std::string previous_commit_hash, std::string message) {
+        ObjectId get_tree_hash() {
+            return tree_hash;
+        }
+
+        std::string_view get_commit_message() {
+            return commit_message;
+        }
+
+        unsigned long get_timestamp() {
+            return timestamp;
+        }
+
+        // branch is the one the commit is made on, empty on a detached HEAD
+        static Commit *create_commit_from_index(Index &index, const ObjectId &previous_commit_hash,
+                                                std::string_view branch, std::string message) {
             Commit *new_commit = new Commit();
 
-            new_commit->commit_hash = Files::create_hash(HASH_LENGTH);
-            new_commit->tree_hash = Files::create_hash(HASH_LENGTH);
             new_commit->parent_hash = previous_commit_hash;
-            new_commit->commit_message = message;
             new_commit->timestamp = time(nullptr);
 
-            int files_changed = create_tree_recursively(index.get_entries(), new_commit->tree_hash, previous_commit_hash,
-                                                        ".");
+            std::vector<uint32_t> tracked;
+            for (uint32_t position: index.get_sorted_positions()) {
+                if (index.get_stage(position) != UNTRACKED) tracked.push_back(position);
+            }
+
+            const ObjectId previous_tree_hash = previous_commit_hash.is_null() ? ObjectId()
+                                                                               : Commit(previous_commit_hash).tree_hash;
+            ObjectArena arena;
+            int files_changed = create_tree_recursively(index, tracked, 0, tracked.size(), 0, previous_tree_hash,
+                                                        new_commit->tree_hash, arena.get());
+            new_commit->write_to_file(message);
 
-            std::cout << "[master] " << new_commit->commit_hash << ": " << message << std::endl;
+            std::cout << "[" << (branch.empty() ? "detached HEAD" : branch) << "] " << new_commit->commit_hash << ": " << message << std::endl;
             std::cout << files_changed << " files changed" << std::endl;
 
-            for (auto entry: index.get_entries()) {
-                if (entry->stage_number == STAGED) {
-                    std::cout << "  " << entry->path << std::endl;
+            for (size_t i = 0; i < index.size(); i++) {
+                if (index.get_stage(i) == STAGED) {
+                    std::cout << "  " << index.get_path(i) << std::endl;
                 }
             }
             index.unsatge_entries();
@@ -58,184 +89,192 @@ namespace gitc {
             return new_commit;
         }
 
-        void print_commit(bool is_head) {
-            std::cout << "commit: " << commit_hash << (is_head ? " (HEAD -> master)" : "") << std::endl;
-            std::cout << "time: " << timestamp << std::endl << std::endl;
-            std::cout << "\t" << commit_message << std::endl << std::endl;
+        // head_branch is the current branch if the commit is HEAD, empty otherwise
+        void print_commit(std::string_view head_branch) {
+            print_commit(commit_hash, timestamp, commit_message, head_branch);
         }
 
-        void update_working_directory() {
-            // update the current working directory to the state of the commit
-            Files::clear_working_dir_recursively();
-            update_working_directory_recursively(tree_hash, "");
+        // the hash is cut to its first hash_length digits
+        static void print_commit(const ObjectId &commit_hash, unsigned long timestamp,
+                                 std::string_view commit_message, std::string_view head_branch,
+                                 size_t hash_length = ObjectId::HEX_SIZE) {
+            std::cout << "commit: " << commit_hash.to_hex().substr(0, hash_length);
+            if (!head_branch.empty()) std::cout << " (HEAD -> " << head_branch << ")";
+            std::cout << "\n";
+            std::cout << "time: " << timestamp << "\n\n";
+            std::cout << "\t" << commit_message << "\n\n";
         }
 
-        void delete_commit() {
-            // delete the commit from the .gitc/objects directory
-            recursively_delete_tree(tree_hash, new Commit(parent_hash));
+        void update_working_directory(Index &index) {
+            // update the current working directory to the state of the commit, only touching the files
+            // that differ from what the index tracks. in a sparse checkout, files outside the cones are
+            // only tracked, they are neither written nor deleted
+            const SparseCheckout &sparse = SparseCheckout::get();
+            ObjectArena arena;
+            std::map<std::string, Tracked_file> files;
+            list_files_recursively(tree_hash, "", files, arena.get(), &sparse);
+
+            const std::string root = Files::root_path();
+            std::map<std::string, ObjectId> tracked;
+
+            for (size_t i = 0; i < index.size(); i++) {
+                if (index.get_stage(i) != UNTRACKED && index.get_type(i) != Tree::TREE)
+                    tracked[index.get_path(i)] = index.get_hash(i);
+            }
+
+            for (auto &file: tracked) {
+                if (files.count(file.first) == 0 && sparse.contains_file(file.first)) {
+                    Files::delete_file(Files::join_path(root, file.first));
+                    Files::remove_empty_parent_dirs(root, file.first);
+                }
+            }
+
+            for (auto &file: files) {
+                if (file.second.type == Tree::TREE || !sparse.contains_file(file.first)) continue;
+
+                auto tracked_file = tracked.find(file.first);
+                if (tracked_file != tracked.end() && tracked_file->second == file.second.hash) continue;
+
+                // copy the object contents to the current working directory
+                const std::string path = Files::join_path(root, file.first);
+                Files::make_parent_dirs(path);
+                Blob::write_to_file(file.second.hash, file.second.type, path);
+            }
+
+            index.reset_to(files);
         }
 
     private:
-        std::string commit_hash;
-        std::string tree_hash;
-        std::string parent_hash;
-        std::string commit_message;
-        unsigned long timestamp;
+        ObjectId commit_hash;
+        ObjectId tree_hash;
+        ObjectId parent_hash;
+        std::string_view commit_message;
+        unsigned long timestamp = 0;
+        std::pmr::string content; // the commit object, "tree <hash>\nparent <hash>\ntime <time>\n<message>\n"
 
         Commit() {}
 
         void read_from_file() {
-            std::string file_path = Files::join_path(Files::root_path(), ".gitc/objects/" + commit_hash);
-            std::ifstream file(file_path);
+            if (!ObjectDatabase::get().read(commit_hash, content)) {
+                return;
+            }
 
-            std::string line;
-            std::getline(file, line);
-            std::istringstream iss(line);
+            std::string_view rest = content;
+            tree_hash = ObjectId::from_hex(header_value(next_line(rest), "tree "));
+            parent_hash = ObjectId::from_hex(header_value(next_line(rest), "parent "));
 
-            std::string type;
-            iss >> type >> tree_hash;
+            const std::string_view time = header_value(next_line(rest), "time ");
+            std::from_chars(time.data(), time.data() + time.size(), timestamp);
 
-            std::getline(file, line);
-            iss = std::istringstream(line);
-            iss >> type >> parent_hash;
+            commit_message = next_line(rest);
+        }
 
-            std::getline(file, line);
-            iss = std::istringstream(line);
-            iss >> type >> timestamp;
+        void write_to_file(std::string_view message) {
+            std::ostringstream file;
 
-            std::getline(file, commit_message);
+            file << "tree " << tree_hash << std::endl;
+            file << "parent " << (parent_hash.is_null() ? "" : parent_hash.to_hex()) << std::endl;
+            file << "time " << timestamp << std::endl;
+            file << message << std::endl;
 
-            file.close();
+            const std::string text = file.str();
+            content.assign(text.data(), text.size());
+            commit_message = std::string_view(content).substr(content.size() - message.size() - 1, message.size());
+            commit_hash = ObjectDatabase::get().write(content);
         }
 
-        void write_to_file() {
-            std::string file_path = Files::join_path(Files::root_path(), ".gitc/objects/" + commit_hash);
-            std::ofstream file(file_path);
+        static std::string_view next_line(std::string_view &rest) {
+            const size_t line_end = rest.find('\n');
+            const std::string_view line = rest.substr(0, line_end);
+            rest = line_end == std::string_view::npos ? std::string_view() : rest.substr(line_end + 1);
+            return line;
+        }
 
-            file << "tree " << tree_hash << std::endl;
-            file << "parent " << parent_hash << std::endl;
-            file << "time " << timestamp << std::endl;
-            file << commit_message << std::endl;
+        // the value of a "<key><value>" header line, empty if the line is something else
+        static std::string_view header_value(std::string_view line, std::string_view key) {
+            return line.substr(0, key.size()) == key ? line.substr(key.size()) : std::string_view();
         }
 
-        static int create_tree_recursively(std::vector<Index_entry *> entries, const std::string &current_tree_hash,
-                                           const std::string &last_commit_hash, const std::string &current_path) {
-            std::vector<std::string> directories;
-            std::vector<std::string> files;
+        // builds the tree of the tracked entries sorted[begin, end), whose paths all start with the directory
+        // this tree is for (prefix_length characters). directories without staged files reuse their tree
+        // from the previous commit
+        static int create_tree_recursively(const Index &index, const std::vector<uint32_t> &sorted, size_t begin,
+                                           size_t end, size_t prefix_length, const ObjectId &previous_tree_hash,
+                                           ObjectId &current_tree_hash, std::pmr::memory_resource *resource) {
+            const PathArena &paths = index.get_path_arena();
+            Tree previous_tree(previous_tree_hash, resource);
+            Tree new_tree(resource);
             int files_changed = 0;
 
-            for (Index_entry *entry: entries) {
-                if (entry->stage_number == UNTRACKED)
-                    continue;
+            for (size_t i = begin; i < end;) {
+                const PathArena::Path path = index.get_path_slice(sorted[i]);
+                const char *name = paths.data(path) + prefix_length;
+                const size_t name_length = path.length - prefix_length;
+                const char *slash = static_cast<const char *>(std::memchr(name, '/', name_length));
 
-                if (entry->path.find('/') != std::string::npos) {
-                    directories.push_back(entry->path.substr(0, entry->path.find('/')));
-                } else {
-                    files.push_back(entry->path);
+                if (slash == nullptr) {
+                    new_tree.add_entry(std::string_view(name, name_length), index.get_hash(sorted[i]), index.get_type(sorted[i]));
+                    if (index.get_stage(sorted[i]) == STAGED) files_changed++;
+                    i++;
+                    continue;
                 }
-            }
-
-            directories.erase(std::unique(directories.begin(), directories.end()), directories.end());
-            files.erase(std::unique(files.begin(), files.end()), files.end());
-
-            Tree *new_tree = new Tree(current_tree_hash);
 
-            for (auto &directory: directories) {
-                std::vector<Index_entry *> directory_entries;
+                // sorted by path, so everything below the directory comes right after its first entry
+                const std::string_view directory(name, slash - name);
+                const size_t directory_prefix_length = prefix_length + directory.size() + 1;
+                size_t directory_end = i;
                 bool changed = false;
-                for (Index_entry *entry: entries) {
-                    if (entry->path.find(directory) == 0) {
-                        Index_entry *new_entry = new Index_entry();
 
-                        new_entry->path = entry->path.substr(entry->path.find('/') + 1);
-                        new_entry->hash = entry->hash;
-                        new_entry->stage_number = entry->stage_number;
-
-                        if (entry->stage_number == STAGED) {
-                            changed = true;
-                        }
-
-                        directory_entries.push_back(new_entry);
+                for (; directory_end < end; directory_end++) {
+                    const PathArena::Path other = index.get_path_slice(sorted[directory_end]);
+                    if (other.length <= directory_prefix_length ||
+                        std::memcmp(paths.data(other), paths.data(path), directory_prefix_length) != 0) {
+                        break;
                     }
-                }
 
-                if (!changed) {
-                    // get the hash of the tree for the same directory from the prev commit
-//                    std::string prev_tree_hash = new_tree->get_hash_of_directory(directory);
-                    Commit *prev_commit = new Commit(last_commit_hash);
-                    Tree *prev_root_tree = new Tree(prev_commit->tree_hash);
-                    std::string prev_tree_hash = prev_root_tree->get_hash_of_directory(
-                            Files::join_path(current_path, directory));
-
-                    new_tree->add_entry(directory, prev_tree_hash, "tree");
-                    continue;
+                    changed |= index.get_stage(sorted[directory_end]) == STAGED;
                 }
 
-                std::string next_tree_hash = Files::create_hash(HASH_LENGTH);
-                files_changed += create_tree_recursively(directory_entries, next_tree_hash, last_commit_hash,
-                                                         Files::join_path(current_path, directory));
-                new_tree->add_entry(directory, next_tree_hash, "tree");
-            }
-
-            for (auto &file: files) {
-                for (Index_entry *entry: entries) {
-                    if (entry->path == file) {
-                        new_tree->add_entry(file, entry->hash, "blob");
+                ObjectId previous_directory_hash;
+                Tree::Tree_entry previous_entry;
+                if (previous_tree.find(directory, previous_entry) && previous_entry.type == Tree::TREE) {
+                    previous_directory_hash = previous_entry.hash;
+                }
 
-                        if (entry->stage_number == STAGED) {
-                            files_changed++;
-                        }
-                    }
+                ObjectId directory_hash = previous_directory_hash;
+                if (changed || directory_hash.is_null()) {
+                    files_changed += create_tree_recursively(index, sorted, i, directory_end, directory_prefix_length,
+                                                             previous_directory_hash, directory_hash, resource);
                 }
+
+                new_tree.add_entry(directory, directory_hash, Tree::TREE);
+                i = directory_end;
             }
 
-            delete new_tree;
+            current_tree_hash = new_tree.write_to_file();
 
             return files_changed;
         }
 
-
-        static void update_working_directory_recursively(const std::string &current_tree_hash,
-                                                         const std::string &path) {
-            Tree *current_tree = new Tree(current_tree_hash);
-            std::vector<Tree::Tree_entry *> entries = current_tree->get_entries();
-
-            for (auto entry: entries) {
-                if (entry->type == "tree") {
-                    Files::make_dir(Files::join_path(Files::root_path(), path + "/" + entry->path).c_str());
-                    update_working_directory_recursively(entry->hash, path + "/" + entry->path);
-                } else {
-                    // copy the file from the .gitc/objects directory to the current working directory
-                    Files::copy_file_contents(Files::join_path(Files::root_path(), ".gitc/objects/" + entry->hash),
-                                              Files::join_path(Files::root_path(), path + "/" + entry->path));
-                }
-            }
-        }
-
-        static void recursively_delete_tree(const std::string &current_tree_hash, Commit* parent_commit) {
-            Tree *current_tree = new Tree(current_tree_hash);
-            std::vector<Tree::Tree_entry *> entries = current_tree->get_entries();
-
-            for (auto entry: entries) {
-                if (parent_commit->depends_on(entry->hash)) { // can do this more efficiently
-                    continue;
-                }
-                if (entry->type == "tree") {
-                    recursively_delete_tree(entry->hash, parent_commit);
+        // with a sparse checkout, directories outside its cones are listed as one TREE entry and never read
+        static void list_files_recursively(const ObjectId &current_tree_hash, const std::string &path,
+                                           std::map<std::string, Tracked_file> &files,
+                                           std::pmr::memory_resource *resource,
+                                           const SparseCheckout *sparse = nullptr) {
+            Tree current_tree(current_tree_hash, resource);
+
+            for (const Tree::Tree_entry &entry: current_tree) {
+                const std::string entry_path = path.empty() ? std::string(entry.path) : path + "/" += entry.path;
+
+                if (entry.type == Tree::TREE && sparse != nullptr &&
+                    sparse->match_directory(entry_path) == SparseCheckout::OUTSIDE) {
+                    files[entry_path] = {entry.hash, Tree::TREE};
+                } else if (entry.type == Tree::TREE) {
+                    list_files_recursively(entry.hash, entry_path, files, resource, sparse);
                 } else {
-                    Files::delete_file(Files::join_path(Files::root_path(), ".gitc/objects/" + entry->hash));
+                    files[entry_path] = {entry.hash, entry.type};
                 }
             }
-
-            Files::delete_file(Files::join_path(Files::root_path(), ".gitc/objects/" + current_tree_hash));
-        }
-
-        bool depends_on(const std::string &hash) {
-            // check if the current commit has a file with the given hash
-            Tree *current_tree = new Tree(tree_hash);
-            bool res = current_tree->search_for_hash(hash);
-            delete current_tree;
-            return res;
         }
     };
 
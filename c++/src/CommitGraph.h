@@ -0,0 +1,300 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include "Files.h"
+#include "Commit.h"
+#include "ObjectDatabase.h"
+#include "BloomFilter.h"
+#include "Tree.h"
+#include "ObjectId.h"
+#include "ObjectArena.h"
+#include "LockFile.h"
+
+#ifndef GIT_CLONE_COMMITGRAPH_H
+#define GIT_CLONE_COMMITGRAPH_H
+
+namespace gitc {
+
+    struct Commit_graph_entry {
+        ObjectId commit_hash;
+        ObjectId tree_hash;
+        uint32_t parent;     // position of the parent in the graph, or NO_PARENT
+        uint32_t generation; // 1 for a root commit, parent's generation + 1 otherwise
+        uint64_t timestamp;
+        uint64_t message_offset;
+        uint64_t bloom_offset;   // filter of the paths changed since the parent, in .gitc/commit-graph-bloom
+        uint32_t message_length;
+        uint32_t bloom_length;
+    };
+
+    static_assert(std::is_trivially_copyable<Commit_graph_entry>::value, "commit-graph records are memcpy'd");
+    static_assert(sizeof(Commit_graph_entry) == 2 * ObjectId::SIZE + 40, "commit-graph records have no padding");
+
+    // .gitc/commit-graph is a header followed by fixed size records in the order the commits were made,
+    // so a parent is always at a lower position than its children and committing only appends a record.
+    // messages live in .gitc/commit-graph-messages, so log never has to open a commit object, and
+    // the changed path filters live in .gitc/commit-graph-bloom, so log -- <path> can skip most trees.
+    // an append holds .gitc/commit-graph.lock
+    class CommitGraph {
+    public:
+        static const uint32_t NO_PARENT = 0xffffffff;
+
+        CommitGraph() {
+            read_from_file();
+        }
+
+        size_t size() const {
+            return entries.size();
+        }
+
+        const Commit_graph_entry &at(uint32_t position) const {
+            return entries[position];
+        }
+
+        static const ObjectId &get_commit_hash(const Commit_graph_entry &entry) {
+            return entry.commit_hash;
+        }
+
+        static const ObjectId &get_tree_hash(const Commit_graph_entry &entry) {
+            return entry.tree_hash;
+        }
+
+        std::string get_message(const Commit_graph_entry &entry) {
+            if (!messages_loaded) {
+                Files::read_file(messages_path(), messages);
+                messages_loaded = true;
+            }
+
+            if (entry.message_offset + entry.message_length > messages.size()) return "";
+            return messages.substr(entry.message_offset, entry.message_length);
+        }
+
+        // false if the commit definitely didn't change path (or anything below it)
+        bool may_have_changed(const Commit_graph_entry &entry, const std::string &path) {
+            if (!bloom_loaded) {
+                Files::read_file(bloom_path(), bloom);
+                bloom_loaded = true;
+            }
+
+            if (entry.bloom_offset + entry.bloom_length > bloom.size()) return true;
+            return BloomFilter(bloom.substr(entry.bloom_offset, entry.bloom_length)).maybe_contains(path);
+        }
+
+        bool lookup(const ObjectId &commit_hash, uint32_t &position) {
+            if (commit_hash.is_null()) return false;
+
+            // the commit being looked up is usually HEAD, which is the last one appended
+            if (!entries.empty() && entries.back().commit_hash == commit_hash) {
+                position = (uint32_t) entries.size() - 1;
+                return true;
+            }
+
+            if (sorted_positions.size() != entries.size()) {
+                sorted_positions.resize(entries.size());
+                for (uint32_t i = 0; i < entries.size(); i++) sorted_positions[i] = i;
+
+                std::sort(sorted_positions.begin(), sorted_positions.end(), [this](uint32_t a, uint32_t b) {
+                    return entries[a].commit_hash < entries[b].commit_hash;
+                });
+            }
+
+            auto it = std::lower_bound(sorted_positions.begin(), sorted_positions.end(), commit_hash,
+                                       [this](uint32_t a, const ObjectId &hash) {
+                                           return entries[a].commit_hash < hash;
+                                       });
+
+            if (it == sorted_positions.end() || entries[*it].commit_hash != commit_hash) return false;
+
+            position = *it;
+            return true;
+        }
+
+        // like lookup, but commits made before the graph existed are imported from their objects first
+        bool lookup_or_import(const ObjectId &commit_hash, uint32_t &position) {
+            if (lookup(commit_hash, position)) return true;
+
+            // only the ids are kept while walking down, every commit is parsed again (in an arena that is
+            // released after each one) when it is appended, so a long history doesn't stay in memory
+            std::vector<ObjectId> missing;
+            ObjectArena arena;
+            ObjectId hash = commit_hash;
+            uint32_t parent_position = NO_PARENT;
+
+            while (!hash.is_null() && !lookup(hash, parent_position) && ObjectDatabase::get().exists(hash)) {
+                missing.push_back(hash);
+                arena.release();
+                hash = Commit(hash, arena.get()).get_parent_commit_hash();
+            }
+
+            bool found = !missing.empty() && missing.front() == commit_hash;
+
+            for (auto it = missing.rbegin(); it != missing.rend(); it++) {
+                arena.release();
+                Commit commit(*it, arena.get());
+                if (append(commit) == NO_PARENT) return false;
+            }
+
+            return found && lookup(commit_hash, position);
+        }
+
+        // returns the commit's position, or NO_PARENT if the graph is locked by another command
+        uint32_t append(Commit &commit) {
+            // two commands appending at once would interleave their records, or cut each other's off
+            LockFile lock(graph_path());
+            if (!lock.is_locked()) return NO_PARENT;
+            reload_if_changed();
+
+            Commit_graph_entry entry{};
+
+            entry.commit_hash = commit.get_commit_hash();
+            entry.tree_hash = commit.get_tree_hash();
+
+            uint32_t parent_position;
+            if (!commit.get_parent_commit_hash().is_null() && lookup(commit.get_parent_commit_hash(), parent_position)) {
+                entry.parent = parent_position;
+                entry.generation = entries[parent_position].generation + 1;
+            } else {
+                entry.parent = NO_PARENT;
+                entry.generation = 1;
+            }
+
+            if (entries.empty()) write_header();
+
+            const std::string_view message = commit.get_commit_message();
+            entry.timestamp = commit.get_timestamp();
+            entry.message_offset = Files::file_size(messages_path());
+            entry.message_length = (uint32_t) message.size();
+
+            std::ofstream messages_file(messages_path(), std::ios::binary | std::ios::app);
+            messages_file << message;
+            messages_file.close();
+
+            const std::string filter = changed_paths_filter(
+                    entry.parent == NO_PARENT ? ObjectId() : get_tree_hash(entries[entry.parent]), commit.get_tree_hash());
+            entry.bloom_offset = Files::file_size(bloom_path());
+            entry.bloom_length = (uint32_t) filter.size();
+
+            std::ofstream bloom_file(bloom_path(), std::ios::binary | std::ios::app);
+            bloom_file << filter;
+            bloom_file.close();
+
+            // the bytes of a torn record go first, or this one and every later one would be misaligned
+            if (has_torn_tail) {
+                Files::truncate_file(graph_path(), HEADER_SIZE + entries.size() * sizeof(Commit_graph_entry));
+                has_torn_tail = false;
+            }
+
+            std::ofstream graph_file(graph_path(), std::ios::binary | std::ios::app);
+            graph_file.write(reinterpret_cast<const char *>(&entry), sizeof entry);
+            graph_file.close();
+
+            if (messages_loaded) messages += message;
+            if (bloom_loaded) bloom += filter;
+            entries.push_back(entry);
+            return (uint32_t) entries.size() - 1;
+        }
+
+        // true if the commit at ancestor is reachable from the commit at descendant by following parents
+        bool is_ancestor(uint32_t ancestor, uint32_t descendant) const {
+            while (descendant != NO_PARENT && entries[descendant].generation > entries[ancestor].generation) {
+                descendant = entries[descendant].parent;
+            }
+
+            return descendant == ancestor;
+        }
+
+    private:
+        static constexpr const char *HEADER = "CGPH\x03\0\0\0";
+        static const size_t HEADER_SIZE = 8;
+
+        std::vector<Commit_graph_entry> entries;
+        bool has_torn_tail = false; // the file has bytes after the last entry that was read
+        std::vector<uint32_t> sorted_positions; // entry positions sorted by commit hash, built on first lookup
+        std::string messages;
+        bool messages_loaded = false;
+        std::string bloom;
+        bool bloom_loaded = false;
+
+        static std::string graph_path() {
+            return Files::join_path(Files::root_path(), ".gitc/commit-graph");
+        }
+
+        static std::string messages_path() {
+            return Files::join_path(Files::root_path(), ".gitc/commit-graph-messages");
+        }
+
+        static std::string bloom_path() {
+            return Files::join_path(Files::root_path(), ".gitc/commit-graph-bloom");
+        }
+
+        // every changed path and all of its leading directories go into the filter
+        static std::string changed_paths_filter(const ObjectId &parent_tree_hash, const ObjectId &tree_hash) {
+            std::vector<std::string> changed;
+            Tree::diff(parent_tree_hash, tree_hash, "", changed);
+
+            BloomFilter filter(changed.size());
+            for (const std::string &path: changed) {
+                filter.add(path);
+            }
+
+            return filter.get_bits();
+        }
+
+        void write_header() {
+            Files::write_file(graph_path(), std::string(HEADER, HEADER_SIZE));
+            // an unreadable graph is replaced, so the messages it pointed into are stale too
+            Files::write_file(messages_path(), "");
+            Files::write_file(bloom_path(), "");
+            messages.clear();
+            bloom.clear();
+        }
+
+        // another command may have appended since the graph was read, its records are read too
+        void reload_if_changed() {
+            const unsigned long long expected = entries.empty() ? 0 : HEADER_SIZE + entries.size() * sizeof(Commit_graph_entry);
+            if (!has_torn_tail && Files::file_size(graph_path()) == expected) return;
+
+            entries.clear();
+            sorted_positions.clear();
+            messages.clear();
+            messages_loaded = false;
+            bloom.clear();
+            bloom_loaded = false;
+            read_from_file();
+        }
+
+        void read_from_file() {
+            std::string data;
+
+            if (!Files::read_file(graph_path(), data) || data.size() < HEADER_SIZE ||
+                data.compare(0, HEADER_SIZE, HEADER, HEADER_SIZE) != 0) {
+                return;
+            }
+
+            entries.resize((data.size() - HEADER_SIZE) / sizeof(Commit_graph_entry));
+            std::memcpy(entries.data(), data.data() + HEADER_SIZE, entries.size() * sizeof(Commit_graph_entry));
+
+            // a parent is always before its child, an entry that says otherwise is garbage and so is
+            // everything after it
+            for (uint32_t position = 0; position < entries.size(); position++) {
+                if (entries[position].parent != NO_PARENT && entries[position].parent >= position) {
+                    entries.resize(position);
+                    break;
+                }
+            }
+
+            has_torn_tail = data.size() != HEADER_SIZE + entries.size() * sizeof(Commit_graph_entry);
+        }
+    };
+
+} // gitc
+
+#endif //GIT_CLONE_COMMITGRAPH_H
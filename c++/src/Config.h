@@ -0,0 +1,55 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <fstream>
+#include <map>
+#include "Files.h"
+
+#ifndef GIT_CLONE_CONFIG_H
+#define GIT_CLONE_CONFIG_H
+
+namespace gitc {
+
+    // .gitc/config, one "key = value" per line. lines starting with # are comments
+    class Config {
+    public:
+        static std::string get(const std::string &key, const std::string &default_value) {
+            const std::map<std::string, std::string> &values = load();
+            auto value = values.find(key);
+            return value == values.end() ? default_value : value->second;
+        }
+
+    private:
+        // read once per command
+        static const std::map<std::string, std::string> &load() {
+            static const std::map<std::string, std::string> values = read_from_file();
+            return values;
+        }
+
+        static std::map<std::string, std::string> read_from_file() {
+            std::map<std::string, std::string> values;
+            std::ifstream config_file(Files::join_path(Files::root_path(), ".gitc/config"));
+            std::string line;
+
+            while (std::getline(config_file, line)) {
+                const size_t equals = line.find('=');
+                if (line.empty() || line[0] == '#' || equals == std::string::npos) continue;
+
+                values[trim(line.substr(0, equals))] = trim(line.substr(equals + 1));
+            }
+
+            return values;
+        }
+
+        static std::string trim(const std::string &text) {
+            const size_t start = text.find_first_not_of(" \t");
+            if (start == std::string::npos) return "";
+            return text.substr(start, text.find_last_not_of(" \t\r") - start + 1);
+        }
+    };
+
+} // gitc
+
+#endif //GIT_CLONE_CONFIG_H
@@ -0,0 +1,77 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <string_view>
+#include <atomic>
+#include <iostream>
+#include "Files.h"
+#include "Config.h"
+
+#ifndef GIT_CLONE_DURABILITY_H
+#define GIT_CLONE_DURABILITY_H
+
+namespace gitc {
+
+    // how much of what a command writes survives a crash, set with "durability = none|batch|per-object"
+    // in .gitc/config. every write goes through a temporary file and a rename in all three, so files are
+    // never torn; the levels differ in when they reach the disk:
+    //   none:       whenever the OS gets to it
+    //   batch:      objects are synced together, with one syncfs right before the first file that points
+    //               at them (the index, HEAD, a ref or a pack) is written, and those files are synced
+    //   per-object: every file is synced before it is renamed into place
+    class Durability {
+    public:
+        enum Level {
+            NONE, BATCH, PER_OBJECT
+        };
+
+        static Level level() {
+            static const Level configured = read_level();
+            return configured;
+        }
+
+        // a loose object, nothing refers to it yet
+        static bool write_object(const std::string &path, std::string_view content) {
+            const bool written = Files::replace_file(path, content, level() == PER_OBJECT);
+            if (level() == BATCH) unsynced_objects().store(true);
+            return written;
+        }
+
+        // a file that may refer to objects, which are made durable before it
+        static bool write_file(const std::string &path, std::string_view content) {
+            sync_objects();
+            return Files::replace_file(path, content, level() != NONE);
+        }
+
+        // like write_file, for a file that was written to temp_path in full
+        static bool rename_file(const std::string &temp_path, const std::string &path) {
+            sync_objects();
+            return Files::rename_file(temp_path, path, level() != NONE);
+        }
+
+        // one syncfs for all objects written since the last one
+        static void sync_objects() {
+            if (!unsynced_objects().exchange(false)) return;
+            Files::sync_file_system(Files::join_path(Files::root_path(), ".gitc"));
+        }
+
+    private:
+        static std::atomic<bool> &unsynced_objects() {
+            static std::atomic<bool> unsynced(false);
+            return unsynced;
+        }
+
+        static Level read_level() {
+            const std::string value = Config::get("durability", "batch");
+            if (value == "none") return NONE;
+            if (value == "per-object") return PER_OBJECT;
+            if (value != "batch") std::cout << "warning: unknown durability '" << value << "', using batch" << std::endl;
+            return BATCH;
+        }
+    };
+
+} // gitc
+
+#endif //GIT_CLONE_DURABILITY_H
@@ -0,0 +1,111 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstring>
+
+#ifndef GIT_CLONE_EWAHBITMAP_H
+#define GIT_CLONE_EWAHBITMAP_H
+
+namespace gitc {
+
+    // a bitmap compressed with EWAH (enhanced word aligned hybrid): a marker word says how many all-zero
+    // or all-one words follow, then how many literal words are copied verbatim after the marker.
+    // marker layout: bit 0 is the running bit, bits 1-32 the running length, bits 33-63 the literal count
+    class EwahBitmap {
+    public:
+        EwahBitmap() {}
+
+        static EwahBitmap compress(const std::vector<uint64_t> &words) {
+            EwahBitmap bitmap;
+            size_t i = 0;
+
+            while (i < words.size()) {
+                const bool running_bit = words[i] == ALL_ONES;
+                const uint64_t clean_word = running_bit ? ALL_ONES : 0;
+                uint64_t running_length = 0, literal_count = 0;
+
+                while (i < words.size() && words[i] == clean_word && running_length < MAX_RUNNING_LENGTH) {
+                    running_length++;
+                    i++;
+                }
+
+                const size_t literals_start = i;
+                while (i < words.size() && words[i] != 0 && words[i] != ALL_ONES &&
+                       literal_count < MAX_LITERAL_COUNT) {
+                    literal_count++;
+                    i++;
+                }
+
+                bitmap.buffer.push_back((uint64_t) running_bit | running_length << 1 | literal_count << 33);
+                bitmap.buffer.insert(bitmap.buffer.end(), words.begin() + literals_start, words.begin() + i);
+            }
+
+            return bitmap;
+        }
+
+        // ors the bitmap into words without decompressing it first, growing words when needed.
+        // the positions of the bits that weren't set in words before are appended to added
+        void or_into(std::vector<uint64_t> &words, std::vector<size_t> *added = nullptr) const {
+            size_t position = 0;
+
+            for (size_t i = 0; i < buffer.size();) {
+                const uint64_t marker = buffer[i++];
+                const bool running_bit = marker & 1;
+                const uint64_t running_length = (marker >> 1) & MAX_RUNNING_LENGTH;
+                const uint64_t literal_count = marker >> 33;
+
+                if (words.size() < position + running_length + literal_count)
+                    words.resize(position + running_length + literal_count, 0);
+
+                if (running_bit) {
+                    for (uint64_t j = 0; j < running_length; j++) set_word(words, position + j, ALL_ONES, added);
+                }
+                position += running_length;
+
+                for (uint64_t j = 0; j < literal_count && i < buffer.size(); j++) {
+                    set_word(words, position++, buffer[i++], added);
+                }
+            }
+        }
+
+        std::vector<uint64_t> decompress() const {
+            std::vector<uint64_t> words;
+            or_into(words);
+            return words;
+        }
+
+        std::string serialize() const {
+            return std::string(reinterpret_cast<const char *>(buffer.data()), buffer.size() * sizeof(uint64_t));
+        }
+
+        static EwahBitmap deserialize(const std::string &data) {
+            EwahBitmap bitmap;
+            bitmap.buffer.resize(data.size() / sizeof(uint64_t));
+            std::memcpy(bitmap.buffer.data(), data.data(), bitmap.buffer.size() * sizeof(uint64_t));
+            return bitmap;
+        }
+
+    private:
+        static const uint64_t ALL_ONES = ~(uint64_t) 0;
+        static const uint64_t MAX_RUNNING_LENGTH = 0xffffffffULL;
+        static const uint64_t MAX_LITERAL_COUNT = 0x7fffffffULL;
+
+        std::vector<uint64_t> buffer;
+
+        static void set_word(std::vector<uint64_t> &words, size_t word, uint64_t bits, std::vector<size_t> *added) {
+            if (added != nullptr) {
+                for (uint64_t new_bits = bits & ~words[word]; new_bits != 0; new_bits &= new_bits - 1) {
+                    added->push_back(word * 64 + __builtin_ctzll(new_bits));
+                }
+            }
+            words[word] |= bits;
+        }
+    };
+
+} // gitc
+
+#endif //GIT_CLONE_EWAHBITMAP_H
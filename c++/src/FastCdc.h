@@ -0,0 +1,76 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#ifndef GIT_CLONE_FASTCDC_H
+#define GIT_CLONE_FASTCDC_H
+
+namespace gitc {
+
+    // FastCDC content-defined chunking. a gear hash rolls over the data and a chunk ends where the hash's
+    // top bits are all zero, so cut points only depend on the bytes right before them and an edit only
+    // changes the chunks around it. the mask is stricter below the average size and looser above it,
+    // which keeps most chunks close to the average
+    class FastCdc {
+    public:
+        static constexpr size_t MIN_SIZE = 16 * 1024;
+        static constexpr size_t AVERAGE_SIZE = 64 * 1024;
+        static constexpr size_t MAX_SIZE = 256 * 1024;
+
+        // the length of the chunk at the start of data. unless data is the end of the input,
+        // at least MAX_SIZE bytes have to be passed in
+        static size_t cut(const unsigned char *data, size_t length) {
+            if (length <= MIN_SIZE) return length;
+
+            const uint64_t *gear = gear_table();
+            const size_t end = std::min(length, MAX_SIZE);
+            const size_t normal = std::min(end, AVERAGE_SIZE);
+            uint64_t hash = 0;
+            size_t i = MIN_SIZE;
+
+            for (; i < normal; i++) {
+                hash = (hash << 1) + gear[data[i]];
+                if ((hash & MASK_SMALL) == 0) return i + 1;
+            }
+
+            for (; i < end; i++) {
+                hash = (hash << 1) + gear[data[i]];
+                if ((hash & MASK_LARGE) == 0) return i + 1;
+            }
+
+            return end;
+        }
+
+    private:
+        // AVERAGE_SIZE is 2^16, two bits more (and less) than that on either side of it
+        static constexpr uint64_t MASK_SMALL = ~0ULL << (64 - 18);
+        static constexpr uint64_t MASK_LARGE = ~0ULL << (64 - 14);
+
+        // a random value per byte, it has to be the same everywhere so the same data gives the same chunks
+        static const uint64_t *gear_table() {
+            static const struct Table {
+                uint64_t values[256];
+
+                Table() : values() {
+                    uint64_t state = 0x6769746320636463ULL;
+                    for (uint64_t &value: values) {
+                        // splitmix64
+                        uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+                        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+                        z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+                        value = z ^ (z >> 31);
+                    }
+                }
+            } table;
+
+            return table.values;
+        }
+    };
+
+} // gitc
+
+#endif //GIT_CLONE_FASTCDC_H
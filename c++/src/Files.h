@@ -2,12 +2,19 @@
 // Created by Karan Gandhi on 25-12-2023.
 //
 #include <string>
+#include <string_view>
 #include <vector>
 #include <iostream>
 #include <dirent.h>
 #include <fstream>
+#include <sstream>
 #include <unistd.h>
 #include <sys/stat.h>
+#include <fcntl.h>
+#include <cerrno>
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
 #include <random>
 #include <ctime>
 
@@ -20,6 +27,10 @@
 #define PATH_MAX 260
 #endif
 
+#ifndef O_BINARY
+#define O_BINARY 0
+#endif
+
 namespace gitc {
     const int HASH_LENGTH = 8;
 
@@ -33,42 +44,54 @@ namespace gitc {
         static std::vector<std::string> ls_recursive(const std::string &path) {
             // return a vector containing all the files in path
             std::vector<std::string> files;
+            walk_files(path, [&files](std::string &&file) { files.push_back(std::move(file)); });
+            return files;
+        }
+
+        // calls visit(std::string &&file) for every file in path as soon as it is found
+        template<typename Visit>
+        static void walk_files(const std::string &path, Visit &&visit) {
+            walk_files(path, visit, [](const std::string &) { return true; });
+        }
 
+        // like walk_files, only opening the subdirectories enter(const std::string &directory) is true for
+        template<typename Visit, typename Enter>
+        static void walk_files(const std::string &path, Visit &&visit, Enter &&enter) {
             if (auto dir = opendir(path.c_str())) {
                 while (auto f = readdir(dir)) {
-                    if ((std::string) f->d_name == "." || (std::string) f->d_name == ".." ||
-                        (std::string) f->d_name == ".gitc" || (std::string) f->d_name == ".git")
+                    const std::string name = f->d_name;
+                    if (name == "." || name == ".." || name == ".gitc" || name == ".git")
                         continue;
 
                     if (f->d_type == DT_DIR) {
-                        for (auto &file: ls_recursive(join_path(path, f->d_name))) {
-                            files.push_back(file);
-                        }
+                        const std::string directory = join_path(path, name);
+                        if (enter(directory)) walk_files(directory, visit, enter);
                     }
 
                     if (f->d_type == DT_REG) {
-                        files.push_back(join_path(path, f->d_name));
+                        visit(join_path(path, name));
                     }
                 }
+                closedir(dir);
             } else if (file_exists(path)) {
-                files.push_back(join_path(path, "."));
+                visit(join_path(path, "."));
             }
-
-            return files;
         }
 
         static std::string root_path(const std::string &path = get_cwd(), const std::string &previous_path = "") {
             if (path == previous_path) return "";
             if (auto dir = opendir(path.c_str())) {
+                bool found = false;
                 while (auto f = readdir(dir)) {
                     if (std::string(f->d_name) == "." || std::string(f->d_name) == "..")
                         continue;
-                    if (f->d_type == DT_DIR) {
-                        if (std::string(f->d_name) == ".gitc") {
-                            return path;
-                        }
+                    if (f->d_type == DT_DIR && std::string(f->d_name) == ".gitc") {
+                        found = true;
+                        break;
                     }
                 }
+                closedir(dir);
+                if (found) return path;
             }
 
             return root_path(join_path(path, "../"), path);
@@ -92,39 +115,106 @@ namespace gitc {
             return (std::string) new_path;
         }
 
-        static bool check_for_changes(const std::string &file1, const std::string &file2) {
-            // TODO: This doesn't work if lines were appended at the end.
-            std::ifstream f1(file1);
-            std::ifstream f2(file2);
-
-            if (!f1.good() || !f2.good() || f1.peek() != f2.peek()) {
-                return true;
+        // reads the whole file straight into content (any string type), with a single read. false for
+        // anything that isn't a regular file
+        template<typename String>
+        static bool read_file(const std::string &path, String &content) {
+            const int fd = open(path.c_str(), O_RDONLY | O_BINARY);
+            if (fd < 0) return false;
+
+            struct stat info;
+            bool complete = fstat(fd, &info) == 0 && S_ISREG(info.st_mode);
+            if (complete) content.resize((size_t) info.st_size);
+
+            for (size_t done = 0; complete && done < content.size();) {
+                const ssize_t count = ::read(fd, &content[done], content.size() - done);
+                complete = count > 0;
+                if (complete) done += (size_t) count;
             }
 
-            std::string line1, line2;
+            close(fd);
+            return complete;
+        }
 
-            while (std::getline(f1, line1) && std::getline(f2, line2)) {
-                if (line1 != line2 || f1.peek() != f2.peek()) {
-                    return true;
-                }
+        // path always holds either its old or its whole new content, see replace_file
+        static bool write_file(const std::string &path, std::string_view content) {
+            return replace_file(path, content, false);
+        }
+
+        // writes content to a temporary file next to path and renames it over path, so a reader or a crash
+        // never sees a partial file. with sync the file, and then the rename, are flushed to disk first
+        static bool replace_file(const std::string &path, std::string_view content, bool sync) {
+            std::string temp_path;
+            const int fd = create_temp_file(path, ".", temp_path);
+            if (fd < 0) return false;
+
+            bool written = true;
+            for (size_t done = 0; written && done < content.size();) {
+                const ssize_t count = ::write(fd, content.data() + done, content.size() - done);
+                written = count > 0;
+                if (written) done += (size_t) count;
             }
 
+            if (written && sync) written = fsync(fd) == 0;
+            close(fd);
 
+            if (written && rename_file(temp_path, path, sync)) return true;
+
+            unlink(temp_path.c_str());
             return false;
         }
 
-        static void copy_file_contents(const std::string &file1, const std::string &file2) {
-            std::ifstream f1(file1);
-            std::ofstream f2(file2);
+        // creates a new file next to path, named path, separator and 6 random characters, for writing
+        static int create_temp_file(const std::string &path, const std::string &separator, std::string &temp_path) {
+#ifdef __linux__
+            temp_path = path + separator + "XXXXXX";
+            const int fd = mkstemp(&temp_path[0]);
+            if (fd >= 0) fchmod(fd, 0644);
+            return fd;
+#else
+            for (int attempt = 0; attempt < 100; attempt++) {
+                temp_path = path + separator + create_hash(6);
+                const int fd = open(temp_path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_BINARY, 0644);
+                if (fd >= 0 || errno != EEXIST) return fd;
+            }
+            return -1;
+#endif
+        }
 
-            std::string line;
+        // moves a finished temporary file over path. with sync it's flushed to disk, and so is the rename.
+        // if it can't be moved, temp_path is left to the caller
+        static bool rename_file(const std::string &temp_path, const std::string &path, bool sync) {
+            if (sync && !sync_file(temp_path)) return false;
+            if (std::rename(temp_path.c_str(), path.c_str()) != 0) return false;
 
-            while (std::getline(f1, line)) {
-                f2 << line << std::endl;
-            }
+            if (!sync) return true;
+            const size_t slash = path.rfind('/');
+            return sync_file(slash == std::string::npos ? "." : path.substr(0, slash));
+        }
+
+        // fsync on a file or directory
+        static bool sync_file(const std::string &path) {
+            const int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) return false;
+
+            const bool synced = fsync(fd) == 0;
+            close(fd);
+            return synced;
+        }
+
+        // flushes everything written to the file system path is on with one call
+        static bool sync_file_system(const std::string &path) {
+#ifdef __linux__
+            const int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) return false;
 
-            f1.close();
-            f2.close();
+            const bool synced = syncfs(fd) == 0;
+            close(fd);
+            return synced;
+#else
+            sync();
+            return true;
+#endif
         }
 
         static void create_gitc_dir(const std::string &path) {
@@ -163,6 +253,17 @@ namespace gitc {
             return f.good();
         }
 
+        static unsigned long long file_size(const std::string &path) {
+            struct stat info;
+            if (stat(path.c_str(), &info) != 0) return 0;
+            return (unsigned long long) info.st_size;
+        }
+
+        // cuts path down to size bytes, or leaves it alone if it's already that short
+        static bool truncate_file(const std::string &path, unsigned long long size) {
+            return file_size(path) <= size || truncate(path.c_str(), (off_t) size) == 0;
+        }
+
         static void make_dir(const std::string &path) {
 #ifdef __linux__
             mkdir(path.c_str(), 0777);
@@ -175,6 +276,20 @@ namespace gitc {
             rmdir(path.c_str());
         }
 
+        static void make_parent_dirs(const std::string &path) {
+            for (size_t slash = path.find('/', 1); slash != std::string::npos; slash = path.find('/', slash + 1)) {
+                make_dir(path.substr(0, slash));
+            }
+        }
+
+        // removes the directories of root/path that became empty, deepest first
+        static void remove_empty_parent_dirs(const std::string &root, std::string path) {
+            for (size_t slash = path.rfind('/'); slash != std::string::npos; slash = path.rfind('/')) {
+                path.erase(slash);
+                if (rmdir(join_path(root, path).c_str()) != 0) return;
+            }
+        }
+
         static void clear_working_dir_recursively(const std::string& path = root_path()) {
             if (auto dir = opendir(path.c_str())) {
                 while (auto f = readdir(dir)) {
@@ -206,6 +321,53 @@ namespace gitc {
         }
     };
 
+    // a whole file, read only. mapped on linux, so opening a large file reads none of it, and only the
+    // pages that are looked at are ever loaded
+    class MappedFile {
+    public:
+        explicit MappedFile(const std::string &path) {
+#ifdef __linux__
+            const int fd = open(path.c_str(), O_RDONLY);
+            if (fd < 0) return;
+
+            struct stat info;
+            if (fstat(fd, &info) == 0 && info.st_size > 0) {
+                void *mapped = mmap(nullptr, (size_t) info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapped != MAP_FAILED) {
+                    data = static_cast<const char *>(mapped);
+                    size = (size_t) info.st_size;
+                }
+            }
+            close(fd);
+#else
+            std::ifstream file(path, std::ios::binary);
+            content.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            data = content.data();
+            size = content.size();
+#endif
+        }
+
+        ~MappedFile() {
+#ifdef __linux__
+            if (data != nullptr) munmap(const_cast<char *>(data), size);
+#endif
+        }
+
+        MappedFile(const MappedFile &) = delete;
+        MappedFile &operator=(const MappedFile &) = delete;
+
+        std::string_view get() const {
+            return data == nullptr ? std::string_view() : std::string_view(data, size);
+        }
+
+    private:
+        const char *data = nullptr;
+        size_t size = 0;
+#ifndef __linux__
+        std::string content;
+#endif
+    };
+
 } // gitc
 
 #endif //GIT_CLONE_FILES_H
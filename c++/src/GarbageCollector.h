@@ -0,0 +1,232 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <ctime>
+#include <cstdint>
+#include <sys/stat.h>
+#include "Files.h"
+#include "Index.h"
+#include "Commit.h"
+#include "Tree.h"
+#include "Blob.h"
+#include "ObjectDatabase.h"
+#include "ReachabilityBitmaps.h"
+#include "Reflog.h"
+#include "Refs.h"
+#include "ObjectArena.h"
+
+#ifndef GIT_CLONE_GARBAGECOLLECTOR_H
+#define GIT_CLONE_GARBAGECOLLECTOR_H
+
+namespace gitc {
+
+    // unreachable objects younger than this are kept, they may belong to a command that is still running
+    const long GC_GRACE_PERIOD = 2 * 7 * 24 * 60 * 60;
+
+    // mark and sweep over every object in the database. each object gets a bit, so marking visits
+    // every reachable object exactly once and the whole collection is linear in the number of objects
+    class GarbageCollector {
+    public:
+        explicit GarbageCollector(ObjectDatabase &_db = ObjectDatabase::get()) : db(_db), bitmaps(_db) {
+            db.list(ids);
+            std::sort(ids.begin(), ids.end());
+            ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+            marked.assign((ids.size() + 63) / 64, 0);
+        }
+
+        // marks the commit, its ancestors and everything their trees point to.
+        // objects that weren't marked before are appended to newly_marked
+        void mark_commit(const ObjectId &commit_hash, std::vector<ObjectId> *newly_marked = nullptr) {
+            if (!bitmaps.available()) {
+                mark(commit_hash, COMMIT, newly_marked);
+                return;
+            }
+
+            // a marked commit was marked with everything it reaches. the other roots extend one walk, which
+            // only hands back what it didn't have yet, so every object is marked once however many roots
+            if (commit_hash.is_null() || is_marked(commit_hash)) return;
+
+            std::vector<ObjectId> objects;
+            walk.added = &objects;
+            bitmaps.extend(commit_hash, walk);
+            walk.added = nullptr;
+
+            for (const ObjectId &hash: objects) {
+                if (set_mark(hash) && newly_marked != nullptr) newly_marked->push_back(hash);
+            }
+        }
+
+        void mark_index(Index &index) {
+            for (size_t i = 0; i < index.size(); i++) {
+                if (index.get_stage(i) != UNTRACKED) mark(index.get_hash(i), object_type(index.get_type(i)), nullptr);
+            }
+        }
+
+        // every commit a branch or tag points to, loose or packed
+        void mark_refs() {
+            for (const Refs::Ref &ref: Refs::get().list("refs/")) {
+                mark_commit(ref.hash);
+            }
+        }
+
+        std::vector<ObjectId> get_marked() const {
+            std::vector<ObjectId> result;
+            for (const ObjectId &id: ids) {
+                if (is_marked(id)) result.push_back(id);
+            }
+            return result;
+        }
+
+        // every commit a ref pointed to since expire_time, so a revert can be undone until the entry expires.
+        // the reflogs are read from the newest entry, up to the first one that expired
+        void mark_reflogs(time_t expire_time) {
+            for (const std::string &ref: Reflog::list_refs()) {
+                Reflog::scan_reverse(ref, [this, expire_time](const Reflog_entry &entry) {
+                    if ((time_t) entry.timestamp < expire_time) return false;
+
+                    mark_commit(entry.old_hash);
+                    mark_commit(entry.new_hash);
+                    return true;
+                });
+            }
+        }
+
+        bool is_marked(const ObjectId &hash) const {
+            long position = position_of(hash);
+            return position >= 0 && (marked[position / 64] >> (position % 64) & 1);
+        }
+
+        // deletes the unmarked loose objects that haven't been modified for grace_period seconds,
+        // and returns how many were deleted. temporary files of writes that never finished go too
+        size_t sweep(long grace_period) {
+            std::vector<ObjectId> loose_ids;
+            RepositoryObjectDatabase *repository = dynamic_cast<RepositoryObjectDatabase *>(&db);
+
+            if (repository == nullptr) {
+                // nothing to parallelize (or to age) outside of a loose object directory
+                size_t removed = 0;
+                for (const ObjectId &id: ids) {
+                    if (!is_marked(id) && db.remove(id)) removed++;
+                }
+                return removed;
+            }
+
+            LooseObjectDatabase &loose = repository->get_loose();
+            std::vector<std::string> temporaries;
+            loose.list(loose_ids, temporaries);
+
+            std::vector<ObjectId> candidates;
+            for (const ObjectId &id: loose_ids) {
+                if (!is_marked(id)) candidates.push_back(id);
+            }
+
+            const time_t now = time(nullptr);
+            std::atomic<size_t> removed(0);
+            size_t number_of_threads = std::max(1u, std::thread::hardware_concurrency());
+            number_of_threads = std::min(number_of_threads, candidates.size() / 64 + 1);
+
+            auto sweep_part = [&](size_t part) {
+                for (size_t i = part; i < candidates.size(); i += number_of_threads) {
+                    struct stat info;
+                    const std::string path = loose.object_path(candidates[i]);
+
+                    if (stat(path.c_str(), &info) != 0 || now - info.st_mtime < grace_period) continue;
+                    if (std::remove(path.c_str()) == 0) removed++;
+                }
+            };
+
+            // a younger one may still be written to
+            for (const std::string &path: temporaries) {
+                struct stat info;
+                if (stat(path.c_str(), &info) == 0 && now - info.st_mtime >= grace_period) std::remove(path.c_str());
+            }
+
+            std::vector<std::thread> threads;
+            for (size_t part = 1; part < number_of_threads; part++) {
+                threads.emplace_back(sweep_part, part);
+            }
+            sweep_part(0);
+
+            for (std::thread &thread: threads) {
+                thread.join();
+            }
+
+            return removed;
+        }
+
+    private:
+        enum Object_type {
+            COMMIT, TREE, BLOB, CHUNKED
+        };
+
+        static Object_type object_type(Tree::Entry_type type) {
+            if (type == Tree::TREE) return TREE;
+            return type == Tree::CHUNKED ? CHUNKED : BLOB;
+        }
+
+        ObjectDatabase &db;
+        ReachabilityBitmaps bitmaps;
+        ReachabilityBitmaps::Walk walk; // shared by the roots marked through the bitmaps
+        std::vector<ObjectId> ids; // sorted, the position of an id is its bit
+        std::vector<uint64_t> marked;
+
+        long position_of(const ObjectId &hash) const {
+            auto it = std::lower_bound(ids.begin(), ids.end(), hash);
+            if (it == ids.end() || *it != hash) return -1;
+            return it - ids.begin();
+        }
+
+        // returns false if the object doesn't exist or was already marked
+        bool set_mark(const ObjectId &hash) {
+            long position = position_of(hash);
+            if (position < 0 || (marked[position / 64] >> (position % 64) & 1)) return false;
+
+            marked[position / 64] |= (uint64_t) 1 << (position % 64);
+            return true;
+        }
+
+        void mark(const ObjectId &hash, Object_type type, std::vector<ObjectId> *newly_marked) {
+            std::vector<std::pair<ObjectId, Object_type>> stack;
+            stack.emplace_back(hash, type);
+
+            // every object is parsed into the arena and done with before the next one, so it's released each time
+            ObjectArena arena;
+
+            while (!stack.empty()) {
+                std::pair<ObjectId, Object_type> object = stack.back();
+                stack.pop_back();
+                arena.release();
+
+                if (object.first.is_null() || !set_mark(object.first)) continue;
+                if (newly_marked != nullptr) newly_marked->push_back(object.first);
+
+                if (object.second == COMMIT) {
+                    Commit commit(object.first, arena.get());
+                    stack.emplace_back(commit.get_tree_hash(), TREE);
+                    stack.emplace_back(commit.get_parent_commit_hash(), COMMIT);
+                } else if (object.second == TREE) {
+                    Tree tree(object.first, arena.get());
+                    for (const Tree::Tree_entry &entry: tree) {
+                        stack.emplace_back(entry.hash, object_type(entry.type));
+                    }
+                } else if (object.second == CHUNKED) {
+                    std::vector<ObjectId> chunks;
+                    Blob::read_chunks(object.first, chunks);
+                    for (const ObjectId &chunk: chunks) {
+                        stack.emplace_back(chunk, BLOB);
+                    }
+                }
+            }
+        }
+    };
+
+} // gitc
+
+#endif //GIT_CLONE_GARBAGECOLLECTOR_H
@@ -0,0 +1,164 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <bitset>
+#include <algorithm>
+
+#ifndef GIT_CLONE_GLOB_H
+#define GIT_CLONE_GLOB_H
+
+namespace gitc {
+
+    // a glob compiled to an automaton: ?, [...], * and **. "**/" at the start of a component also
+    // matches nothing, so "a/**/b" matches "a/b". * stops at a / unless star_matches_slash is set
+    class Glob {
+    public:
+        Glob() = default;
+
+        explicit Glob(std::string_view glob, bool star_matches_slash = false) {
+            for (size_t i = 0; i < glob.size(); i++) {
+                const char c = glob[i];
+                const bool at_component_start = i == 0 || glob[i - 1] == '/';
+
+                if (c == '*' && i + 1 < glob.size() && glob[i + 1] == '*' && at_component_start &&
+                    (i + 2 == glob.size() || glob[i + 2] == '/')) {
+                    if (i + 2 == glob.size()) {
+                        tokens.push_back({DOUBLE_STAR, 0, 0});
+                    } else {
+                        tokens.push_back({SKIP, 0, 0});
+                        tokens.push_back({DOUBLE_STAR, 0, 0});
+                        tokens.push_back({CHAR, '/', 0});
+                    }
+                    i += 2;
+                } else if (c == '*') {
+                    while (i + 1 < glob.size() && glob[i + 1] == '*') i++;
+                    tokens.push_back({star_matches_slash ? DOUBLE_STAR : STAR, 0, 0});
+                } else if (c == '?') {
+                    tokens.push_back({ANY, 0, 0});
+                } else if (c == '[' && glob.find(']', i + 2) != std::string_view::npos) {
+                    tokens.push_back({CLASS, 0, (int) classes.size()});
+                    i = compile_class(glob, i + 1);
+                } else if (c == '\\' && i + 1 < glob.size()) {
+                    tokens.push_back({CHAR, glob[++i], 0});
+                } else {
+                    tokens.push_back({CHAR, c, 0});
+                }
+            }
+        }
+
+        // the characters of a glob are wildcards, or escape one
+        static bool has_wildcards(std::string_view text) {
+            return text.find_first_of("*?[\\") != std::string_view::npos;
+        }
+
+        // runs the automaton with one state per token: the set of reachable states advances a character
+        // at a time, so matching is linear in the text whatever the stars
+        bool matches(std::string_view text) const {
+            std::vector<char> current(tokens.size() + 1, 0), next(tokens.size() + 1, 0);
+            current[0] = 1;
+            close(current);
+
+            for (const char c: text) {
+                std::fill(next.begin(), next.end(), 0);
+                bool any = false;
+
+                for (size_t state = 0; state < tokens.size(); state++) {
+                    if (!current[state]) continue;
+                    const Token &token = tokens[state];
+
+                    switch (token.type) {
+                        case CHAR:
+                            if (token.character == c) next[state + 1] = any = true;
+                            break;
+                        case ANY:
+                            if (c != '/') next[state + 1] = any = true;
+                            break;
+                        case CLASS:
+                            if (classes[token.set].test((unsigned char) c)) next[state + 1] = any = true;
+                            break;
+                        case STAR:
+                            if (c != '/') next[state] = any = true;
+                            break;
+                        case DOUBLE_STAR:
+                            next[state] = any = true;
+                            break;
+                        case SKIP:
+                            break;
+                    }
+                }
+
+                if (!any) return false;
+                close(next);
+                current.swap(next);
+            }
+
+            return current[tokens.size()];
+        }
+
+    private:
+        enum Token_type : uint8_t {
+            CHAR,         // one character
+            ANY,          // ?, one character other than /
+            CLASS,        // [...]
+            STAR,         // *, any number of characters other than /
+            DOUBLE_STAR,  // any number of characters, / included
+            SKIP          // before the DOUBLE_STAR of "**/": the whole "**/" can match nothing
+        };
+
+        struct Token {
+            Token_type type;
+            char character;
+            int set; // of a CLASS, in classes
+        };
+
+        std::vector<Token> tokens;
+        std::vector<std::bitset<256>> classes;
+
+        // the class starting at glob[start], returns the position of its ]
+        size_t compile_class(std::string_view glob, size_t start) {
+            std::bitset<256> set;
+            size_t i = start;
+            const bool negated = glob[i] == '!' || glob[i] == '^';
+            if (negated) i++;
+
+            for (bool first = true; i < glob.size() && (glob[i] != ']' || first); i++, first = false) {
+                const unsigned char low = (unsigned char) glob[i];
+                if (i + 2 < glob.size() && glob[i + 1] == '-' && glob[i + 2] != ']') {
+                    for (unsigned c = low; c <= (unsigned char) glob[i + 2]; c++) set.set(c);
+                    i += 2;
+                } else {
+                    set.set(low);
+                }
+            }
+
+            if (negated) {
+                set.flip();
+                set.reset('/');
+            }
+
+            classes.push_back(set);
+            return i;
+        }
+
+        // adds the states reachable without reading a character
+        void close(std::vector<char> &states) const {
+            for (size_t state = 0; state < tokens.size(); state++) {
+                if (!states[state]) continue;
+
+                if (tokens[state].type == STAR || tokens[state].type == DOUBLE_STAR) {
+                    states[state + 1] = 1;
+                } else if (tokens[state].type == SKIP) {
+                    states[state + 1] = 1;
+                    states[state + 3] = 1;
+                }
+            }
+        }
+    };
+
+} // gitc
+
+#endif //GIT_CLONE_GLOB_H
@@ -4,65 +4,87 @@
 
 #include <string>
 #include "Files.h"
+#include "ObjectDatabase.h"
+#include "Refs.h"
+#include "Durability.h"
+#include "ObjectId.h"
 
 #ifndef GIT_CLONE_HEAD_H
 #define GIT_CLONE_HEAD_H
 
 namespace gitc {
 
+    // HEAD names the branch commits go to ("refs/heads/master"), the branch is a ref like any other
     class Head {
     public:
-        Head() { // no support for branches yet
+        Head() {
             read_from_file();
         }
 
+        // HEAD and the branch are only rewritten when they moved
         ~Head() {
-            write_to_file();
+            if (modified) write_to_file();
         }
 
+        // makes ref the current branch, without touching the working directory
         void update_head_ref(const std::string &ref) {
             head_ref = ref;
+            last_commit_hash = read_ref(ref);
+            loaded_hash = last_commit_hash;
+            head_ref_modified = true;
+            modified = true;
         }
 
-        void update_last_commit_hash(const std::string &hash) {
+        // the branch and its reflog are written when the command is done
+        void update_last_commit_hash(const ObjectId &hash, const std::string &reflog_message) {
             last_commit_hash = hash;
+            this->reflog_message = reflog_message;
+            modified = true;
+        }
+
+        std::string get_head_ref() {
+            return head_ref;
+        }
+
+        // the name of the current branch, "master" for refs/heads/master
+        std::string get_branch() {
+            const std::string_view prefix = Refs::BRANCH_PREFIX;
+            return head_ref.compare(0, prefix.size(), prefix) == 0 ? head_ref.substr(prefix.size()) : head_ref;
         }
 
         static void init() {
-            std::ofstream head_file(Files::join_path(Files::root_path(), ".gitc/HEAD"));
-            head_file << "refs/heads/master";
-            head_file.close();
+            Durability::write_file(Files::join_path(Files::root_path(), ".gitc/HEAD"), "refs/heads/master");
 
+            Files::make_dir(Files::join_path(Files::root_path(), ".gitc/refs").c_str());
             Files::make_dir(Files::join_path(Files::root_path(), ".gitc/refs/heads").c_str());
-
-            std::ofstream master(Files::join_path(Files::root_path(), ".gitc/refs/heads/master"));
-            master << "";
-            master.close();
+            Files::make_dir(Files::join_path(Files::root_path(), ".gitc/refs/tags").c_str());
         }
 
-        std::string get_last_commit_hash() {
+        ObjectId get_last_commit_hash() {
             return last_commit_hash;
         }
 
-        static bool commit_exists(const std::string &hash) {
-            return Files::file_exists(Files::join_path(Files::root_path(), ".gitc/objects/" + hash));
+        static bool commit_exists(const ObjectId &hash) {
+            return !hash.is_null() && ObjectDatabase::get().exists(hash);
         }
 
     private:
         std::string head_ref;
-        std::string last_commit_hash;
+        ObjectId last_commit_hash; // null before the first commit
+        ObjectId loaded_hash;      // what the branch pointed to when it was read
+        std::string reflog_message;
+        bool modified = false;
+        bool head_ref_modified = false;
 
         void write_to_file() {
-            std::ofstream head_file(Files::join_path(Files::root_path(), ".gitc/HEAD"));
-            head_file << head_ref;
-            head_file.close();
-
-            Files::make_dir(Files::join_path(Files::root_path(), ".gitc/refs").c_str());
-            Files::make_dir(Files::join_path(Files::root_path(), ".gitc/refs/heads").c_str());
-
-            std::ofstream master(Files::join_path(Files::root_path(), ".gitc/refs/heads/master"));
-            master << last_commit_hash;
-            master.close();
+            if (head_ref_modified) {
+                Durability::write_file(Files::join_path(Files::root_path(), ".gitc/HEAD"), head_ref);
+            }
+
+            // another command may have moved the branch since it was read, its commit isn't overwritten
+            if (last_commit_hash != loaded_hash) {
+                Refs::get().update(head_ref, last_commit_hash, loaded_hash, reflog_message);
+            }
         }
 
         void read_from_file() {
@@ -70,9 +92,14 @@ namespace gitc {
             std::getline(head_file, head_ref);
             head_file.close();
 
-            std::ifstream master(Files::join_path(Files::root_path(), ".gitc/" + head_ref));
-            std::getline(master, last_commit_hash);
-            master.close();
+            last_commit_hash = read_ref(head_ref);
+            loaded_hash = last_commit_hash;
+        }
+
+        static ObjectId read_ref(const std::string &ref) {
+            ObjectId hash;
+            Refs::get().read(ref, hash);
+            return hash;
         }
     };
 
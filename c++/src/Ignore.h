@@ -0,0 +1,163 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <fstream>
+#include <algorithm>
+#include "Files.h"
+#include "Glob.h"
+
+#ifndef GIT_CLONE_IGNORE_H
+#define GIT_CLONE_IGNORE_H
+
+namespace gitc {
+
+    // the gitignore-style patterns of the .gitcignore file at the root, compiled once. most patterns are
+    // a name ("build"), an extension ("*.o") or a prefix ("tmp*"), those are looked up in hash tables, and
+    // only the rest go through a glob automaton. walks ask about a directory before opening it, so an
+    // ignored directory is never read
+    class Ignore {
+    public:
+        static const Ignore &get() {
+            static const Ignore ignore(Files::join_path(Files::root_path(), ".gitcignore"));
+            return ignore;
+        }
+
+        explicit Ignore(const std::string &path) {
+            std::ifstream file(path);
+            std::string line;
+
+            while (std::getline(file, line)) {
+                add_pattern(line);
+            }
+        }
+
+        // path is relative to the root. the last pattern that matches decides, a "!pattern" re-includes
+        bool is_ignored(std::string_view path, bool is_directory) const {
+            if (patterns.empty()) return false;
+
+            while (path.compare(0, 2, "./") == 0) path.remove_prefix(2);
+            const size_t slash = path.rfind('/');
+            const std::string_view name = slash == std::string_view::npos ? path : path.substr(slash + 1);
+
+            int best = -1;
+            lookup(literals, name, is_directory, best);
+            lookup(paths, path, is_directory, best);
+
+            const size_t dot = name.rfind('.');
+            if (!suffixes.empty() && dot != std::string_view::npos) {
+                auto candidates = suffixes.find(std::string(name.substr(dot)));
+                if (candidates != suffixes.end()) {
+                    for (int index: candidates->second) {
+                        const std::string &suffix = patterns[index].text;
+                        if (index > best && applies(index, is_directory) && name.size() >= suffix.size() &&
+                            name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+                            best = index;
+                        }
+                    }
+                }
+            }
+
+            for (size_t length = 1; length <= name.size() && length <= longest_prefix; length++) {
+                lookup(prefixes, name.substr(0, length), is_directory, best);
+            }
+
+            // globs are kept in pattern order, the ones before best can't change the outcome
+            for (auto glob = globs.rbegin(); glob != globs.rend() && *glob > best; ++glob) {
+                const Pattern &pattern = patterns[*glob];
+                if (applies(*glob, is_directory) && pattern.glob.matches(pattern.anchored ? path : name)) {
+                    best = *glob;
+                }
+            }
+
+            return best >= 0 && !patterns[best].negated;
+        }
+
+    private:
+        struct Pattern {
+            std::string text;          // the literal part for the tables
+            Glob glob;
+            bool negated = false;
+            bool directory_only = false;
+            bool anchored = false;     // has a /, so it's matched against the whole path
+        };
+
+        std::vector<Pattern> patterns;
+        std::unordered_map<std::string, std::vector<int>> literals; // name -> patterns
+        std::unordered_map<std::string, std::vector<int>> paths;    // anchored path -> patterns
+        std::unordered_map<std::string, std::vector<int>> suffixes; // extension -> "*<suffix>" patterns
+        std::unordered_map<std::string, std::vector<int>> prefixes; // "<prefix>*" patterns
+        size_t longest_prefix = 0;
+        std::vector<int> globs;
+
+        bool applies(int index, bool is_directory) const {
+            return is_directory || !patterns[index].directory_only;
+        }
+
+        void lookup(const std::unordered_map<std::string, std::vector<int>> &table, std::string_view key,
+                    bool is_directory, int &best) const {
+            if (table.empty()) return;
+
+            auto candidates = table.find(std::string(key));
+            if (candidates == table.end()) return;
+
+            for (int index: candidates->second) {
+                if (index > best && applies(index, is_directory)) best = index;
+            }
+        }
+
+        void add_pattern(std::string line) {
+            while (!line.empty() && (line.back() == '\r' || (line.back() == ' ' && !ends_escaped(line)))) line.pop_back();
+            if (line.empty() || line[0] == '#') return;
+
+            Pattern pattern;
+            if (line[0] == '!') {
+                pattern.negated = true;
+                line.erase(0, 1);
+            } else if (line[0] == '\\') {
+                line.erase(0, 1);
+            }
+
+            if (!line.empty() && line.back() == '/') {
+                pattern.directory_only = true;
+                line.pop_back();
+            }
+
+            pattern.anchored = line.find('/') != std::string::npos;
+            if (!line.empty() && line[0] == '/') line.erase(0, 1);
+            if (line.empty()) return;
+
+            const int index = (int) patterns.size();
+            const size_t wildcard = line.find_first_of("*?[\\");
+
+            if (wildcard == std::string::npos) {
+                pattern.text = line;
+                (pattern.anchored ? paths : literals)[line].push_back(index);
+            } else if (!pattern.anchored && line[0] == '*' && line.find_first_of("*?[\\", 1) == std::string::npos &&
+                       line.find('.') != std::string::npos) {
+                pattern.text = line.substr(1);
+                suffixes[pattern.text.substr(pattern.text.rfind('.'))].push_back(index);
+            } else if (!pattern.anchored && wildcard > 0 && wildcard == line.size() - 1 && line.back() == '*') {
+                pattern.text = line.substr(0, wildcard);
+                prefixes[pattern.text].push_back(index);
+                longest_prefix = std::max(longest_prefix, pattern.text.size());
+            } else {
+                pattern.glob = Glob(line);
+                globs.push_back(index);
+            }
+
+            patterns.push_back(std::move(pattern));
+        }
+
+        static bool ends_escaped(const std::string &line) {
+            return line.size() >= 2 && line[line.size() - 2] == '\\';
+        }
+    };
+
+} // gitc
+
+#endif //GIT_CLONE_IGNORE_H
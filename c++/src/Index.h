@@ -4,6 +4,20 @@
 #include <string>
 #include <sstream>
 #include <algorithm>
+#include <map>
+#include "Files.h"
+#include "ObjectDatabase.h"
+#include "ObjectId.h"
+#include "PathArena.h"
+#include "Tree.h"
+#include "Blob.h"
+#include "Durability.h"
+#include "Config.h"
+#include "SparseCheckout.h"
+#include "Ignore.h"
+#include "Pathspec.h"
+#include "ObjectArena.h"
+#include "Sha256.h"
 
 #ifndef GIT_CLONE_INDEX_H
 #define GIT_CLONE_INDEX_H
@@ -18,95 +32,213 @@ namespace gitc {
         UNMODIFIED, STAGED, UNTRACKED
     };
 
-    struct Index_entry {
-        std::string path;
-        std::string hash;
-        Stage_number stage_number = UNTRACKED;
+    // the object a tracked path points to
+    struct Tracked_file {
+        ObjectId hash;
+        Tree::Entry_type type;
     };
 
-
+    // the index keeps its entries as parallel arrays (one per field) in the order they were added, and
+    // every path in one arena. a scan over the stages, like has_untracked_files, reads a byte per entry
     class Index {
     public:
         Index() {
             readFromFiles();
-
-            std::vector<std::string> files = Files::ls_recursive(Files::relative_root_path());
-            for (std::string &file: files) {
-                if (!has_entry(file)) {
-                    Index_entry *new_entry = new Index_entry();
-
-                    new_entry->path = file;
-                    new_entry->stage_number = UNTRACKED;
-                    new_entry->hash = Files::create_hash(HASH_LENGTH); // now come up with a hash function
-
-//                    std::cout << new_entry->path << (int) new_entry->stage_number << new_entry->hash << std::endl;
-                    entries.push_back(new_entry);
-                }
+            expand_directories();
+
+            // a sparse checkout only has its cones on disk, the directories outside them are never opened,
+            // and neither are ignored ones
+            const SparseCheckout &sparse = SparseCheckout::get();
+            const Ignore &ignore = Ignore::get();
+            std::vector<std::string> untracked;
+            Files::walk_files(Files::relative_root_path(), [&](std::string &&file) {
+                if (sparse.contains_file(file) && !has_entry(file) && !ignore.is_ignored(file, false))
+                    untracked.push_back(std::move(file));
+            }, [&sparse, &ignore](const std::string &directory) {
+                return sparse.match_directory(directory) != SparseCheckout::OUTSIDE &&
+                       !ignore.is_ignored(directory, true);
+            });
+
+            // they aren't written to the index, so they don't count as changes to the split index's base
+            for (std::string &file: untracked) {
+                append(file, ObjectId(), Tree::BLOB, UNTRACKED, false);
             }
-
-            Files::make_dir(".gitc/objects");
         }
 
+        // the index file is only rewritten when an entry changed. untracked files aren't worth a write,
+        // they are found again by the next command anyway
         ~Index() {
-            writeToFile();
-            for (Index_entry *entry: entries)
-                delete entry;
-
-            entries.clear();
+            if (modified) writeToFile();
         }
 
         void update(const std::string &path, Index_updates updates) {
+            const long position = find(path);
+            if (position < 0) return;
+
             if (updates == ADD) {
-                for (Index_entry *entry: entries) {
-                    if (entry->path == path) {
-                        const std::string current_object_path = Files::join_path(Files::root_path(Files::get_cwd()),
-                                                                                 ".gitc/objects/" + entry->hash);
-
-                        if (Files::check_for_changes(path, current_object_path)) {
-                            entry->hash = Files::create_hash(HASH_LENGTH);
-                            entry->stage_number = STAGED;
-
-                            const std::string new_object_path = Files::join_path(Files::root_path(Files::get_cwd()),
-                                                                                 ".gitc/objects/" + entry->hash);
-                            Files::copy_file_contents(path, new_object_path);
-                        }
-                    }
-                }
+                Tree::Entry_type type;
+                const ObjectId hash = Blob::store(path, type);
+                stage(position, hash, type);
             } else if (updates == REMOVE) {
-                // make the file untracked
-                for (Index_entry *entry: entries) {
-                    if (entry->path == path) {
-                        entry->stage_number = UNTRACKED;
-                        Files::delete_file(
-                                Files::join_path(Files::root_path(Files::get_cwd()), ".gitc/objects/" + entry->hash));
-                    }
+                // make the file untracked, the object may still be used by older commits, gc deletes it otherwise
+                if (stages[position] != UNTRACKED) {
+                    stages[position] = UNTRACKED;
+                    changed[position] = true;
+                    modified = true;
                 }
             }
         }
 
+        // stages path as the already stored object hash
+        void stage(const std::string &path, const ObjectId &hash, Tree::Entry_type type) {
+            const long position = find(path);
+            if (position >= 0) stage(position, hash, type);
+        }
+
         bool has_entry(const std::string &path) {
-//            std::cout << "Has entry: " << path << std::endl;
-            for (Index_entry *entry: entries) {
-                if (entry->path == path) {
-                    return true;
+            return find(path) >= 0;
+        }
+
+        void unsatge_entries() {
+            staged = false;
+            for (size_t i = 0; i < stages.size(); i++) {
+                if (stages[i] == STAGED) {
+                    stages[i] = UNMODIFIED;
+                    changed[i] = true;
+                    modified = true;
                 }
             }
-
-//            std::cout << "false" << std::endl;
-            return false;
         }
 
-        void unsatge_entries() {
+        // track exactly files, as they are after a checkout. untracked entries are kept
+        void reset_to(const std::map<std::string, Tracked_file> &files) {
+            std::vector<std::string> untracked;
+
+            for (size_t i = 0; i < size(); i++) {
+                if (stages[i] == UNTRACKED && files.count(get_path(i)) == 0) untracked.push_back(get_path(i));
+            }
+
+            clear();
+            for (const std::string &path: untracked) {
+                append(path, ObjectId(), Tree::BLOB, UNTRACKED, false);
+            }
+
+            for (auto &file: files) {
+                append(file.first, file.second.hash, file.second.type, UNMODIFIED);
+            }
+
+            rewrite_base = true;
+            modified = true;
+
             staged = false;
-            for (auto entry : entries) {
-                if (entry->stage_number == STAGED) {
-                    entry->stage_number = UNMODIFIED;
+        }
+
+        // in a sparse checkout, a directory outside the cones is one TREE entry with the directory's tree,
+        // so the index grows with the cones rather than with the repository. this replaces every such entry
+        // that is no longer outside the cones with the entries of its tree and returns the positions of the
+        // files that were added that way
+        std::vector<size_t> expand_directories() {
+            const SparseCheckout &sparse = SparseCheckout::get();
+            std::vector<size_t> expanded;
+
+            bool needed = false;
+            for (size_t i = 0; i < size() && !needed; i++) {
+                needed = types[i] == Tree::TREE && sparse.match_directory(get_path(i)) != SparseCheckout::OUTSIDE;
+            }
+            if (!needed) return expanded;
+
+            std::vector<Index_record> records;
+            std::vector<uint8_t> was_changed = changed;
+            for (size_t i = 0; i < size(); i++) {
+                records.push_back({get_path(i), hashes[i], types[i], stages[i]});
+            }
+
+            clear();
+            for (size_t i = 0; i < records.size(); i++) {
+                const Index_record &record = records[i];
+                if (record.type != Tree::TREE || sparse.match_directory(record.path) == SparseCheckout::OUTSIDE) {
+                    append(record.path, record.hash, static_cast<Tree::Entry_type>(record.type),
+                           static_cast<Stage_number>(record.stage), was_changed[i]);
+                    continue;
+                }
+
+                const size_t first = size();
+                expand(record.path, record.hash);
+                deleted.push_back(record.path);
+
+                for (size_t position = first; position < size(); position++) {
+                    if (types[position] != Tree::TREE) expanded.push_back(position);
                 }
             }
+
+            modified = true;
+            return expanded;
         }
 
-        std::vector<Index_entry *> get_entries() {
-            return entries;
+        size_t size() const {
+            return paths.size();
+        }
+
+        std::string get_path(size_t position) const {
+            return arena.get(paths[position]);
+        }
+
+        PathArena::Path get_path_slice(size_t position) const {
+            return paths[position];
+        }
+
+        const PathArena &get_path_arena() const {
+            return arena;
+        }
+
+        const ObjectId &get_hash(size_t position) const {
+            return hashes[position];
+        }
+
+        Tree::Entry_type get_type(size_t position) const {
+            return static_cast<Tree::Entry_type>(types[position]);
+        }
+
+        Stage_number get_stage(size_t position) const {
+            return static_cast<Stage_number>(stages[position]);
+        }
+
+        // positions of the entries, ordered by path
+        const std::vector<uint32_t> &get_sorted_positions() const {
+            if (sorted_positions.size() != size()) {
+                sorted_positions.resize(size());
+                for (uint32_t i = 0; i < size(); i++) sorted_positions[i] = i;
+
+                std::sort(sorted_positions.begin(), sorted_positions.end(), [this](uint32_t a, uint32_t b) {
+                    return arena.compare(paths[a], paths[b]) < 0;
+                });
+            }
+
+            return sorted_positions;
+        }
+
+        // calls visit(position) for every entry the pathspec matches, in path order. a directory the pathspec
+        // can't match is skipped as a whole, by a binary search for the first entry after it
+        template<typename Visit>
+        void for_each_match(const Pathspec &pathspec, Visit &&visit) const {
+            const std::vector<uint32_t> &sorted = get_sorted_positions();
+
+            for (auto it = sorted.begin(); it != sorted.end();) {
+                const std::string path = get_path(*it);
+                const size_t rejected = pathspec.rejected_directory(path);
+
+                if (rejected == 0) {
+                    if (pathspec.matches(path)) visit((size_t) *it);
+                    ++it;
+                    continue;
+                }
+
+                // "<directory>0" sorts right after everything in "<directory>/"
+                const std::string end = path.substr(0, rejected) + (char) ('/' + 1);
+                it = std::lower_bound(it, sorted.end(), end, [this](uint32_t a, const std::string &b) {
+                    return arena.compare(paths[a], b.data(), b.size()) < 0;
+                });
+            }
         }
 
         bool is_staged() {
@@ -114,64 +246,248 @@ namespace gitc {
         }
 
         bool has_untracked_files() {
-            bool res = false;
+            return std::find(stages.begin(), stages.end(), (uint8_t) UNTRACKED) != stages.end();
+        }
 
-            for (auto entry : entries)
-                res |= entry->stage_number == UNTRACKED;
+    private:
+        static constexpr const char *VERSION = "gitc_version_1.1";
+        // a split index: "<count> gitc_version_1.1_split <base id>", and only the entries that differ from
+        // the base, which is a full index in .gitc/sharedindex.<base id>
+        static constexpr const char *SPLIT_VERSION = "gitc_version_1.1_split";
+        // the stage of an entry in the delta that was deleted from the base
+        static const int DELETED = 3;
+        // the delta is folded into a new base once it has more than a tenth of the base's entries
+        static const size_t MAX_DELTA_RATIO = 10;
+
+        struct Index_header {
+            size_t size = 0;
+            bool is_split = false;
+            ObjectId base_id;
+        };
+
+        struct Index_record {
+            std::string path;
+            ObjectId hash;
+            int type = Tree::BLOB;
+            int stage = UNMODIFIED;
+        };
+
+        bool staged = false;
+        bool modified = false; // an entry changed since the index was read
+
+        ObjectId base_id;              // of the split index's base, null if there is none
+        size_t base_size = 0;
+        bool rewrite_base = false;     // when every entry was replaced, the base is of no use anymore
+        std::vector<std::string> deleted; // base entries that are gone
+
+        PathArena arena;
+        std::vector<PathArena::Path> paths;
+        std::vector<ObjectId> hashes;  // null for files that were never added
+        std::vector<uint8_t> types;    // Tree::Entry_type of the object, BLOB or CHUNKED
+        std::vector<uint8_t> stages;   // Stage_number
+        std::vector<uint8_t> changed;  // differs from the split index's base, so it's written to the delta
+        mutable std::vector<uint32_t> sorted_positions; // rebuilt when entries were added
+
+        void stage(long position, const ObjectId &hash, Tree::Entry_type type) {
+            // same contents, same id: an unchanged file doesn't need to be compared byte by byte
+            if (hash != hashes[position] || stages[position] == UNTRACKED) {
+                hashes[position] = hash;
+                types[position] = type;
+                stages[position] = STAGED;
+                changed[position] = true;
+                staged = true;
+                modified = true;
+            }
+        }
 
-            return res;
+        void append(const std::string &path, const ObjectId &hash, Tree::Entry_type type, Stage_number stage,
+                    bool is_changed = true) {
+            paths.push_back(arena.add(path));
+            hashes.push_back(hash);
+            types.push_back((uint8_t) type);
+            stages.push_back((uint8_t) stage);
+            changed.push_back((uint8_t) is_changed);
+            sorted_positions.clear();
         }
 
-    private:
-        bool staged;
-        std::vector<Index_entry *> entries;
+        // appends the entries below directory, whose tree is tree_hash, directories outside the cones as one
+        void expand(const std::string &directory, const ObjectId &tree_hash) {
+            ObjectArena arena;
+            Tree tree(tree_hash, arena.get());
+
+            for (const Tree::Tree_entry &entry: tree) {
+                const std::string path = directory + "/" += entry.path;
+
+                if (entry.type == Tree::TREE && SparseCheckout::get().match_directory(path) != SparseCheckout::OUTSIDE) {
+                    expand(path, entry.hash);
+                } else {
+                    append(path, entry.hash, entry.type, UNMODIFIED);
+                }
+            }
+        }
+
+        void clear() {
+            arena.clear();
+            paths.clear();
+            hashes.clear();
+            types.clear();
+            stages.clear();
+            changed.clear();
+            sorted_positions.clear();
+        }
+
+        long find(const std::string &path) const {
+            const std::vector<uint32_t> &sorted = get_sorted_positions();
+            auto it = std::lower_bound(sorted.begin(), sorted.end(), path, [this](uint32_t a, const std::string &b) {
+                return arena.compare(paths[a], b.data(), b.size()) < 0;
+            });
+
+            if (it == sorted.end() || !arena.equals(paths[*it], path)) return -1;
+            return *it;
+        }
 
         void writeToFile() {
-            // filepath stage_number hash
             const std::string index_file_path = Files::join_path(Files::root_path(Files::get_cwd()), ".gitc/index");
-            std::ofstream index_file(index_file_path);
+            const ObjectId old_base_id = base_id;
+
+            if (Config::get("split-index", "true") != "true") {
+                base_id = ObjectId();
+                Durability::write_file(index_file_path, write_entries(false));
+            } else if (!rewrite_base && !base_id.is_null() && delta_size() * MAX_DELTA_RATIO <= base_size) {
+                Durability::write_file(index_file_path, write_entries(true));
+                return;
+            } else {
+                // fold the delta into a new base, the split index then starts out empty
+                const std::string base = write_entries(false);
+                base_id = Sha256::hash(base);
+                Durability::write_file(base_path(base_id), base);
+                Durability::write_file(index_file_path, "0 " + std::string(SPLIT_VERSION) + " " + base_id.to_hex() + "\n");
+            }
 
-            index_file << entries.size() << " gitc_version_1.0" << std::endl;
-            for (Index_entry *entry: entries) {
-                index_file << entry->path << " " << entry->stage_number << " " << entry->hash << std::endl;
-//                std::cout << entry->path << " " << entry->stage_number << " " << entry->hash << std::endl;
+            if (!old_base_id.is_null() && old_base_id != base_id) Files::delete_file(base_path(old_base_id));
+        }
+
+        // filepath type stage_number hash, one line per entry. a delta only has the entries that differ from
+        // the base, and a DELETED line for every base entry that is gone. untracked files are left out of a
+        // full index, the next command finds them again; a delta only keeps those that hide a base entry
+        std::string write_entries(bool delta) const {
+            std::ostringstream index_file;
+            const ObjectId null_hash;
+
+            const size_t untracked = (size_t) std::count(stages.begin(), stages.end(), (uint8_t) UNTRACKED);
+            index_file << (delta ? delta_size() : size() - untracked) << " ";
+            if (delta) {
+                index_file << SPLIT_VERSION << " " << base_id << "\n";
+            } else {
+                index_file << VERSION << "\n";
+            }
+
+            for (size_t i = 0; i < size(); i++) {
+                if (delta ? !changed[i] : stages[i] == UNTRACKED) continue;
+
+                index_file.write(arena.data(paths[i]), paths[i].length);
+                index_file << " " << (int) types[i] << " " << (int) stages[i] << " " << hashes[i] << "\n";
+            }
+
+            for (size_t i = 0; delta && i < deleted.size(); i++) {
+                index_file << deleted[i] << " " << (int) Tree::BLOB << " " << DELETED << " " << null_hash << "\n";
             }
 
-            index_file.close();
+            return index_file.str();
+        }
+
+        size_t delta_size() const {
+            return deleted.size() + (size_t) std::count(changed.begin(), changed.end(), (uint8_t) true);
+        }
+
+        static std::string base_path(const ObjectId &id) {
+            return Files::join_path(Files::root_path(Files::get_cwd()), ".gitc/sharedindex." + id.to_hex());
         }
 
         void readFromFiles() {
-            // read from the index file
+            // read from the index file. a split index is a delta on top of a base, entries found in the delta
+            // replace the base's and stay in the delta
             const std::string index_file_path = Files::join_path(Files::root_path(Files::get_cwd()), ".gitc/index");
-            std::ifstream index_file(index_file_path);
+            std::map<std::string, Index_record> delta;
+            Index_header header;
+
+            read_index_file(index_file_path, header, [&](Index_record &record) {
+                if (header.is_split) {
+                    std::string path = record.path;
+                    delta[path] = std::move(record);
+                } else {
+                    read_entry(record, false, false);
+                }
+            });
 
-            int size;
-            std::string version;
+            if (!header.is_split) return;
+
+            Index_header base_header;
+            base_id = header.base_id;
+            read_index_file(base_path(base_id), base_header, [&](Index_record &record) {
+                auto replaced = delta.find(record.path);
+                if (replaced == delta.end()) {
+                    read_entry(record, false, true);
+                    return;
+                }
+
+                read_entry(replaced->second, true, true);
+                delta.erase(replaced);
+            });
+            base_size = base_header.size;
+
+            // what is left was added since the base was written
+            for (auto &record: delta) {
+                read_entry(record.second, true, false);
+            }
+        }
+
+        void read_entry(const Index_record &record, bool in_delta, bool in_base) {
+            if (record.stage == STAGED) staged = true;
+
+            // files outside a sparse checkout's cones, and directory entries, are tracked without being on disk
+            if (record.stage != DELETED && (record.type == Tree::TREE ||
+                                            !SparseCheckout::get().contains_file(record.path) ||
+                                            Files::file_exists(record.path))) {
+                append(record.path, record.hash, static_cast<Tree::Entry_type>(record.type),
+                       static_cast<Stage_number>(record.stage), in_delta);
+            } else if (in_base) {
+                deleted.push_back(record.path);
+            }
+        }
+
+        // calls visit(Index_record &) for every line of the index file at path, once header is filled in
+        template<typename Visit>
+        static void read_index_file(const std::string &path, Index_header &header, Visit &&visit) {
+            std::ifstream index_file(path);
+            std::string version, base;
 
             std::string line;
             std::getline(index_file, line);
             std::istringstream iss(line);
-            iss >> size >> version;
+            iss >> header.size >> version >> base;
+
+            header.is_split = version == SPLIT_VERSION;
+            header.base_id = ObjectId::from_hex(base);
 
-            for (int i = 0; i < size; i++) {
-                Index_entry *entry = new Index_entry();
-                int stage_number;
+            for (size_t i = 0; i < header.size && std::getline(index_file, line); i++) {
+                Index_record record;
+                std::string hash;
 
-                std::getline(index_file, line);
                 std::reverse(line.begin(), line.end());
                 std::istringstream current_iss(line);
-                current_iss >> entry->hash >> stage_number;
-                std::getline(current_iss, entry->path);
-
-                std::reverse(entry->hash.begin(), entry->hash.end());
-                std::reverse(entry->path.begin(), entry->path.end());
+                current_iss >> hash >> record.stage;
+                // version 1.0 has no type, everything is a blob
+                if (version != "gitc_version_1.0") current_iss >> record.type;
+                std::getline(current_iss, record.path);
 
-                while(entry->path[(int) entry->path.size() - 1] == ' ') entry->path.pop_back();
+                std::reverse(hash.begin(), hash.end());
+                std::reverse(record.path.begin(), record.path.end());
 
-                entry->stage_number = static_cast<Stage_number>(stage_number);
+                while (!record.path.empty() && record.path.back() == ' ') record.path.pop_back();
 
-                if (stage_number == STAGED) staged = true;
-                if (Files::file_exists(entry->path)) entries.push_back(entry);
+                record.hash = ObjectId::from_hex(hash);
+                visit(record);
             }
         }
     };
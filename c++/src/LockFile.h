@@ -0,0 +1,79 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <string_view>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "Files.h"
+#include "Durability.h"
+
+#ifndef GIT_CLONE_LOCKFILE_H
+#define GIT_CLONE_LOCKFILE_H
+
+namespace gitc {
+
+    // <path>.lock, created exclusively: whoever creates it may change path, by writing the new content
+    // to it and renaming it over path
+    class LockFile {
+    public:
+        explicit LockFile(const std::string &path) : lock_path(path + ".lock") {
+            Files::make_parent_dirs(lock_path);
+            fd = open(lock_path.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+            held = fd >= 0;
+            if (!held) {
+                std::cout << "fatal: unable to create '" << lock_path << "': another gitc process seems to be "
+                          << "running, or one crashed and the file has to be removed" << std::endl;
+            }
+        }
+
+        ~LockFile() {
+            if (fd >= 0) close(fd);
+            if (held) unlink(lock_path.c_str());
+        }
+
+        bool is_locked() const {
+            return held;
+        }
+
+        // the rename releases the lock. if content can't be written or renamed, the lock is still held
+        // until this goes out of scope, so the caller can undo what it did under it
+        bool commit(std::string_view content, const std::string &path) {
+            if (fd < 0) return false;
+
+            bool written = true;
+            for (size_t done = 0; written && done < content.size();) {
+                const ssize_t count = ::write(fd, content.data() + done, content.size() - done);
+                written = count > 0;
+                if (written) done += (size_t) count;
+            }
+
+            struct stat lock_info, info;
+            const bool identified = fstat(fd, &lock_info) == 0;
+            close(fd);
+            fd = -1;
+            if (written && Durability::rename_file(lock_path, path)) {
+                held = false;
+                return true;
+            }
+
+            // when the rename went through and only the sync failed, the lock is gone, and the file
+            // at lock_path, if any, is another command's
+            held = identified ? stat(lock_path.c_str(), &info) == 0 && info.st_ino == lock_info.st_ino &&
+                                info.st_dev == lock_info.st_dev
+                              : !written;
+            return false;
+        }
+
+    private:
+        std::string lock_path;
+        int fd = -1;
+        bool held = false;
+    };
+
+} // gitc
+
+#endif //GIT_CLONE_LOCKFILE_H
@@ -0,0 +1,41 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <memory>
+#include <memory_resource>
+
+#ifndef GIT_CLONE_OBJECTARENA_H
+#define GIT_CLONE_OBJECTARENA_H
+
+namespace gitc {
+
+    // a monotonic arena for the objects parsed by one command or walk. allocating is a pointer bump and
+    // nothing is freed one by one: release() drops everything at once and starts over in the first block,
+    // so a walk that releases after every object allocates from the heap only for its largest object
+    class ObjectArena {
+    public:
+        static const size_t INITIAL_SIZE = 64 * 1024;
+
+        ObjectArena() : initial(new char[INITIAL_SIZE]), resource(initial.get(), INITIAL_SIZE) {}
+
+        ObjectArena(const ObjectArena &) = delete;
+        ObjectArena &operator=(const ObjectArena &) = delete;
+
+        std::pmr::memory_resource *get() {
+            return &resource;
+        }
+
+        // everything allocated from the arena must be destroyed first
+        void release() {
+            resource.release();
+        }
+
+    private:
+        std::unique_ptr<char[]> initial;
+        std::pmr::monotonic_buffer_resource resource;
+    };
+
+} // gitc
+
+#endif //GIT_CLONE_OBJECTARENA_H
@@ -0,0 +1,527 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <string_view>
+#include <memory_resource>
+#include <vector>
+#include <map>
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <utime.h>
+#include "Files.h"
+#include "ObjectId.h"
+#include "Sha256.h"
+#include "Durability.h"
+
+#ifndef GIT_CLONE_OBJECTDATABASE_H
+#define GIT_CLONE_OBJECTDATABASE_H
+
+namespace gitc {
+
+    // every object (blob, tree, commit) is read and written through an ObjectDatabase,
+    // so nothing outside of this file needs to know where .gitc/objects lives
+    class ObjectDatabase {
+    public:
+        virtual ~ObjectDatabase() {}
+
+        virtual bool read(const ObjectId &id, std::string &content) = 0;
+
+        // like read, but into a buffer that keeps its allocator, so parsed objects can live in an arena
+        virtual bool read(const ObjectId &id, std::pmr::string &content) {
+            std::string buffer;
+            if (!read(id, buffer)) return false;
+
+            content.assign(buffer.data(), buffer.size());
+            return true;
+        }
+
+        virtual void write(const ObjectId &id, std::string_view content) = 0;
+
+        // objects are addressed by the hash of their contents, so writing an existing object is a no-op
+        ObjectId write(std::string_view content) {
+            const ObjectId id = Sha256::hash(content);
+            if (!freshen(id)) write(id, content);
+            return id;
+        }
+
+        virtual bool exists(const ObjectId &id) = 0;
+
+        // like exists, for an object that is about to be referred to again: a loose one gets a new mtime,
+        // so a gc running in the background doesn't take it for old garbage and delete it
+        virtual bool freshen(const ObjectId &id) {
+            return exists(id);
+        }
+
+        virtual bool remove(const ObjectId &id) = 0;
+
+        // returns nullptr if the object does not exist
+        virtual std::unique_ptr<std::istream> stream(const ObjectId &id) {
+            std::string content;
+            if (!read(id, content)) return nullptr;
+            return std::unique_ptr<std::istream>(new std::istringstream(content));
+        }
+
+        virtual void list(std::vector<ObjectId> &ids) = 0;
+
+        // appends the ids starting with the first length hex digits of prefix, an id may be appended
+        // more than once. the databases only look where such ids can be, not at every object
+        virtual void find_prefix(const ObjectId &prefix, size_t length, std::vector<ObjectId> &ids) {
+            std::vector<ObjectId> all;
+            list(all);
+            for (const ObjectId &id: all) {
+                if (id.has_hex_prefix(prefix, length)) ids.push_back(id);
+            }
+        }
+
+        virtual void flush() {}
+
+        // the database used by the current repository
+        static ObjectDatabase &get() {
+            std::unique_ptr<ObjectDatabase> &db = instance();
+            if (!db) db = create_default();
+            return *db;
+        }
+
+        // replace the database used by the current repository (eg. with a MemoryObjectDatabase),
+        // nullptr makes the next get() open the repository's objects again
+        static void set(ObjectDatabase *db) {
+            instance().reset(db);
+        }
+
+    private:
+        static std::unique_ptr<ObjectDatabase> &instance() {
+            static std::unique_ptr<ObjectDatabase> db;
+            return db;
+        }
+
+        static std::unique_ptr<ObjectDatabase> create_default();
+    };
+
+    class MemoryObjectDatabase : public ObjectDatabase {
+    public:
+        bool read(const ObjectId &id, std::string &content) override {
+            auto it = objects.find(id);
+            if (it == objects.end()) return false;
+
+            content = it->second;
+            return true;
+        }
+
+        bool read(const ObjectId &id, std::pmr::string &content) override {
+            auto it = objects.find(id);
+            if (it == objects.end()) return false;
+
+            content.assign(it->second.data(), it->second.size());
+            return true;
+        }
+
+        void write(const ObjectId &id, std::string_view content) override {
+            objects[id] = std::string(content);
+        }
+
+        bool exists(const ObjectId &id) override {
+            return objects.count(id) != 0;
+        }
+
+        bool remove(const ObjectId &id) override {
+            return objects.erase(id) != 0;
+        }
+
+        void list(std::vector<ObjectId> &ids) override {
+            for (auto &object: objects) ids.push_back(object.first);
+        }
+
+        void find_prefix(const ObjectId &prefix, size_t length, std::vector<ObjectId> &ids) override {
+            for (auto it = objects.lower_bound(prefix); it != objects.end() && it->first.has_hex_prefix(prefix, length); ++it) {
+                ids.push_back(it->first);
+            }
+        }
+
+    private:
+        std::map<ObjectId, std::string> objects;
+    };
+
+    // one file per object: .gitc/objects/<first two hex digits>/<the other 62>
+    class LooseObjectDatabase : public ObjectDatabase {
+    public:
+        explicit LooseObjectDatabase(const std::string &_objects_dir) : objects_dir(_objects_dir) {}
+
+        bool read(const ObjectId &id, std::string &content) override {
+            return Files::read_file(object_path(id), content);
+        }
+
+        bool read(const ObjectId &id, std::pmr::string &content) override {
+            return Files::read_file(object_path(id), content);
+        }
+
+        void write(const ObjectId &id, std::string_view content) override {
+            const std::string path = object_path(id);
+            Files::make_parent_dirs(path);
+            Durability::write_object(path, content);
+        }
+
+        bool exists(const ObjectId &id) override {
+            return Files::file_exists(object_path(id));
+        }
+
+        bool freshen(const ObjectId &id) override {
+            return utime(object_path(id).c_str(), nullptr) == 0;
+        }
+
+        bool remove(const ObjectId &id) override {
+            return std::remove(object_path(id).c_str()) == 0;
+        }
+
+        std::unique_ptr<std::istream> stream(const ObjectId &id) override {
+            std::unique_ptr<std::istream> file(new std::ifstream(object_path(id), std::ios::binary));
+            if (!file->good()) return nullptr;
+            return file;
+        }
+
+        void list(std::vector<ObjectId> &ids) override {
+            for (int fanout = 0; fanout < 256; fanout++) {
+                list_fanout_dir(fanout, ids);
+            }
+        }
+
+        // like list, and the paths of the temporary files (<object>.XXXXXX) an interrupted write left behind
+        void list(std::vector<ObjectId> &ids, std::vector<std::string> &temporaries) {
+            for (int fanout = 0; fanout < 256; fanout++) {
+                list_fanout_dir(fanout, ids, &temporaries);
+            }
+        }
+
+        // only the fanout directory of the prefix is read, or the 16 a single digit can be in
+        void find_prefix(const ObjectId &prefix, size_t length, std::vector<ObjectId> &ids) override {
+            std::vector<ObjectId> candidates;
+            const int first = prefix.bytes[0];
+
+            for (int fanout = first; fanout <= (length < 2 ? first | 0xf : first); fanout++) {
+                list_fanout_dir(fanout, candidates);
+            }
+
+            for (const ObjectId &id: candidates) {
+                if (id.has_hex_prefix(prefix, length)) ids.push_back(id);
+            }
+        }
+
+        // the ids of the objects in one fanout directory, the ones whose first byte is fanout
+        void list_fanout_dir(int fanout, std::vector<ObjectId> &ids,
+                             std::vector<std::string> *temporaries = nullptr) const {
+            static const char digits[] = "0123456789abcdef";
+            const std::string prefix = {digits[fanout >> 4], digits[fanout & 0xf]};
+            const std::string dir_path = Files::join_path(objects_dir, prefix);
+
+            if (auto dir = opendir(dir_path.c_str())) {
+                while (auto f = readdir(dir)) {
+                    const ObjectId id = ObjectId::from_hex(prefix + f->d_name);
+                    if (!id.is_null()) {
+                        ids.push_back(id);
+                    } else if (temporaries != nullptr && is_temporary(prefix, f->d_name)) {
+                        temporaries->push_back(Files::join_path(dir_path, f->d_name));
+                    }
+                }
+                closedir(dir);
+            }
+        }
+
+        std::string object_path(const ObjectId &id) const {
+            const std::string hex = id.to_hex();
+            return Files::join_path(objects_dir, hex.substr(0, 2) + "/" + hex.substr(2));
+        }
+
+    private:
+        std::string objects_dir;
+
+        // what Files::replace_file writes an object to before renaming it: the object's name and 7 more
+        static bool is_temporary(const std::string &prefix, std::string_view name) {
+            const size_t hex_size = ObjectId::HEX_SIZE - 2;
+            return name.size() == hex_size + 7 && name[hex_size] == '.' &&
+                   !ObjectId::from_hex(prefix + std::string(name.substr(0, hex_size))).is_null();
+        }
+    };
+
+    // objects stored back to back in .gitc/objects/pack/pack-<name>.pack, located through the sorted
+    // pack-<name>.idx. packs are immutable: writes are buffered and become a new pack on flush()
+    class PackObjectDatabase : public ObjectDatabase {
+    public:
+        explicit PackObjectDatabase(const std::string &_pack_dir) : pack_dir(_pack_dir) {
+            load_packs();
+        }
+
+        ~PackObjectDatabase() override {
+            flush();
+        }
+
+        bool read(const ObjectId &id, std::string &content) override {
+            return read_packed(id, content);
+        }
+
+        bool read(const ObjectId &id, std::pmr::string &content) override {
+            return read_packed(id, content);
+        }
+
+        void write(const ObjectId &id, std::string_view content) override {
+            if (find(id) == nullptr) pending.write(id, content);
+        }
+
+        bool exists(const ObjectId &id) override {
+            return pending.exists(id) || find(id) != nullptr;
+        }
+
+        bool remove(const ObjectId &id) override {
+            // packed objects are only dropped when the pack is rewritten
+            return pending.remove(id);
+        }
+
+        void list(std::vector<ObjectId> &ids) override {
+            for (auto &entry: entries) ids.push_back(entry.id);
+            pending.list(ids);
+        }
+
+        // the ids with the prefix are next to each other in the sorted entries
+        void find_prefix(const ObjectId &prefix, size_t length, std::vector<ObjectId> &ids) override {
+            auto it = std::lower_bound(entries.begin(), entries.end(), prefix,
+                                       [](const Pack_entry &entry, const ObjectId &key) {
+                                           return entry.id < key;
+                                       });
+            for (; it != entries.end() && it->id.has_hex_prefix(prefix, length); ++it) {
+                ids.push_back(it->id);
+            }
+            pending.find_prefix(prefix, length, ids);
+        }
+
+        void flush() override {
+            std::vector<ObjectId> ids;
+            pending.list(ids);
+            if (ids.empty()) return;
+
+            write_pack(pack_dir, ids, pending);
+
+            pending = MemoryObjectDatabase();
+            entries.clear();
+            packs.clear();
+            load_packs();
+        }
+
+        // writes the objects (ids must be sorted) from source into a new pack and returns its path
+        // without the .pack/.idx extension
+        static std::string write_pack(const std::string &pack_dir, const std::vector<ObjectId> &ids,
+                                      ObjectDatabase &source) {
+            Files::make_dir(pack_dir);
+            const std::string name = Files::join_path(pack_dir, "pack-" + Files::create_hash(HASH_LENGTH));
+
+            // the pack is only renamed into place once it is complete, and the idx that finds it comes last
+            std::ofstream pack_file(name + ".pack.tmp", std::ios::binary);
+            std::string header = PACK_MAGIC;
+            std::string index_data = INDEX_MAGIC;
+            append_int<uint32_t>(header, (uint32_t) ids.size());
+            append_int<uint32_t>(index_data, INDEX_VERSION);
+            append_int<uint32_t>(index_data, (uint32_t) ids.size());
+            pack_file << header;
+
+            uint64_t offset = header.size();
+            std::string content;
+
+            for (const ObjectId &id: ids) {
+                source.read(id, content);
+
+                index_data.append(reinterpret_cast<const char *>(id.bytes), ObjectId::SIZE);
+                append_int<uint64_t>(index_data, offset);
+                append_int<uint64_t>(index_data, content.size());
+
+                pack_file << content;
+                offset += content.size();
+            }
+
+            pack_file.close();
+            if (!Durability::rename_file(name + ".pack.tmp", name + ".pack")) Files::delete_file(name + ".pack.tmp");
+            Durability::write_file(name + ".idx", index_data);
+
+            return name;
+        }
+
+        const std::string &get_pack_dir() const {
+            return pack_dir;
+        }
+
+        // pack paths without their extension
+        const std::vector<std::string> &get_packs() const {
+            return packs;
+        }
+
+        // the sorted ids stored in one pack, an object's position in it is its position in the pack
+        std::vector<ObjectId> get_pack_ids(size_t pack) const {
+            std::vector<ObjectId> ids;
+            for (auto &entry: entries) {
+                if (entry.pack == pack) ids.push_back(entry.id);
+            }
+            return ids;
+        }
+
+    private:
+        struct Pack_entry {
+            ObjectId id;
+            uint64_t offset;
+            uint64_t size;
+            size_t pack;
+        };
+
+        static constexpr const char *PACK_MAGIC = "GPCK";
+        static constexpr const char *INDEX_MAGIC = "GIDX";
+        static const uint32_t INDEX_VERSION = 2;
+        static const size_t INDEX_ENTRY_SIZE = ObjectId::SIZE + 2 * sizeof(uint64_t); // id, offset, size
+
+        std::string pack_dir;
+        std::vector<std::string> packs;
+        std::vector<Pack_entry> entries; // sorted by id
+        MemoryObjectDatabase pending;
+
+        template<typename T>
+        static void append_int(std::string &out, T value) {
+            out.append(reinterpret_cast<const char *>(&value), sizeof value);
+        }
+
+        template<typename T>
+        static T read_int(const std::string &in, size_t &pos) {
+            T value = 0;
+            if (pos + sizeof value <= in.size()) std::memcpy(&value, in.data() + pos, sizeof value);
+            pos += sizeof value;
+            return value;
+        }
+
+        template<typename String>
+        bool read_packed(const ObjectId &id, String &content) {
+            if (pending.read(id, content)) return true;
+
+            const Pack_entry *entry = find(id);
+            if (entry == nullptr) return false;
+
+            std::ifstream pack(packs[entry->pack] + ".pack", std::ios::binary);
+            pack.seekg((std::streamoff) entry->offset);
+            content.resize(entry->size);
+            pack.read(&content[0], (std::streamsize) entry->size);
+            return pack.good() || entry->size == 0;
+        }
+
+        const Pack_entry *find(const ObjectId &id) const {
+            auto it = std::lower_bound(entries.begin(), entries.end(), id,
+                                       [](const Pack_entry &entry, const ObjectId &key) {
+                                           return entry.id < key;
+                                       });
+            if (it == entries.end() || it->id != id) return nullptr;
+            return &*it;
+        }
+
+        void load_packs() {
+            if (auto dir = opendir(pack_dir.c_str())) {
+                while (auto f = readdir(dir)) {
+                    std::string file_name = f->d_name;
+                    if (file_name.size() > 4 && file_name.compare(file_name.size() - 4, 4, ".idx") == 0) {
+                        load_index(Files::join_path(pack_dir, file_name.substr(0, file_name.size() - 4)));
+                    }
+                }
+                closedir(dir);
+            }
+
+            std::sort(entries.begin(), entries.end(), [](const Pack_entry &a, const Pack_entry &b) {
+                return a.id < b.id;
+            });
+        }
+
+        void load_index(const std::string &name) {
+            std::string index_data;
+            if (!Files::read_file(name + ".idx", index_data) || index_data.compare(0, 4, INDEX_MAGIC) != 0)
+                return;
+
+            size_t pos = 4;
+            if (read_int<uint32_t>(index_data, pos) != INDEX_VERSION) return;
+            uint32_t count = read_int<uint32_t>(index_data, pos);
+
+            // an index cut short only has the entries that are whole
+            packs.push_back(name);
+            for (uint32_t i = 0; i < count && pos + INDEX_ENTRY_SIZE <= index_data.size(); i++) {
+                Pack_entry entry;
+                std::memcpy(entry.id.bytes, index_data.data() + pos, ObjectId::SIZE);
+                pos += ObjectId::SIZE;
+                entry.offset = read_int<uint64_t>(index_data, pos);
+                entry.size = read_int<uint64_t>(index_data, pos);
+                entry.pack = packs.size() - 1;
+                entries.push_back(entry);
+            }
+        }
+    };
+
+    // what a repository uses by default: new objects are written loose, and reads fall back to the packs
+    class RepositoryObjectDatabase : public ObjectDatabase {
+    public:
+        explicit RepositoryObjectDatabase(const std::string &objects_dir)
+                : loose(objects_dir), packed(Files::join_path(objects_dir, "pack")) {}
+
+        bool read(const ObjectId &id, std::string &content) override {
+            return loose.read(id, content) || packed.read(id, content);
+        }
+
+        bool read(const ObjectId &id, std::pmr::string &content) override {
+            return loose.read(id, content) || packed.read(id, content);
+        }
+
+        void write(const ObjectId &id, std::string_view content) override {
+            loose.write(id, content);
+        }
+
+        bool exists(const ObjectId &id) override {
+            return loose.exists(id) || packed.exists(id);
+        }
+
+        // gc only deletes loose objects, a packed one needs no new mtime
+        bool freshen(const ObjectId &id) override {
+            return loose.freshen(id) || packed.exists(id);
+        }
+
+        bool remove(const ObjectId &id) override {
+            return loose.remove(id);
+        }
+
+        std::unique_ptr<std::istream> stream(const ObjectId &id) override {
+            std::unique_ptr<std::istream> in = loose.stream(id);
+            return in ? std::move(in) : packed.stream(id);
+        }
+
+        void list(std::vector<ObjectId> &ids) override {
+            loose.list(ids);
+            packed.list(ids);
+        }
+
+        void find_prefix(const ObjectId &prefix, size_t length, std::vector<ObjectId> &ids) override {
+            loose.find_prefix(prefix, length, ids);
+            packed.find_prefix(prefix, length, ids);
+        }
+
+        LooseObjectDatabase &get_loose() {
+            return loose;
+        }
+
+        PackObjectDatabase &get_packed() {
+            return packed;
+        }
+
+    private:
+        LooseObjectDatabase loose;
+        PackObjectDatabase packed;
+    };
+
+    inline std::unique_ptr<ObjectDatabase> ObjectDatabase::create_default() {
+        return std::unique_ptr<ObjectDatabase>(
+                new RepositoryObjectDatabase(Files::join_path(Files::root_path(), ".gitc/objects")));
+    }
+
+} // gitc
+
+#endif //GIT_CLONE_OBJECTDATABASE_H
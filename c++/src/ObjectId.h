@@ -0,0 +1,132 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <string_view>
+#include <ostream>
+#include <cstring>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+
+#ifndef GIT_CLONE_OBJECTID_H
+#define GIT_CLONE_OBJECTID_H
+
+namespace gitc {
+
+    // the SHA-256 of an object's contents. all zeros is the null id, used for "no object"
+    struct ObjectId {
+        static constexpr size_t SIZE = 32;
+        static constexpr size_t HEX_SIZE = 2 * SIZE;
+
+        unsigned char bytes[SIZE];
+
+        ObjectId() {
+            std::memset(bytes, 0, SIZE);
+        }
+
+        bool is_null() const {
+            static const unsigned char zeros[SIZE] = {};
+            return std::memcmp(bytes, zeros, SIZE) == 0;
+        }
+
+        std::string to_hex() const {
+            static const char digits[] = "0123456789abcdef";
+            std::string hex(HEX_SIZE, '0');
+
+            for (size_t i = 0; i < SIZE; i++) {
+                hex[2 * i] = digits[bytes[i] >> 4];
+                hex[2 * i + 1] = digits[bytes[i] & 0xf];
+            }
+
+            return hex;
+        }
+
+        // the null id if hex isn't a full, valid id
+        static ObjectId from_hex(std::string_view hex) {
+            ObjectId id;
+            if (hex.size() != HEX_SIZE) return id;
+
+            for (size_t i = 0; i < SIZE; i++) {
+                int high = hex_value(hex[2 * i]), low = hex_value(hex[2 * i + 1]);
+                if (high < 0 || low < 0) return ObjectId();
+
+                id.bytes[i] = (unsigned char) (high << 4 | low);
+            }
+
+            return id;
+        }
+
+        // the lowest id whose hex starts with the digits of hex, false if they aren't a valid prefix
+        static bool from_hex_prefix(std::string_view hex, ObjectId &lowest) {
+            lowest = ObjectId();
+            if (hex.empty() || hex.size() > HEX_SIZE) return false;
+
+            for (size_t i = 0; i < hex.size(); i++) {
+                const int value = hex_value(hex[i]);
+                if (value < 0) return false;
+
+                lowest.bytes[i / 2] |= (unsigned char) (i % 2 == 0 ? value << 4 : value);
+            }
+
+            return true;
+        }
+
+        // the first length hex digits are those of prefix
+        bool has_hex_prefix(const ObjectId &prefix, size_t length) const {
+            const size_t whole_bytes = length / 2;
+            if (std::memcmp(bytes, prefix.bytes, whole_bytes) != 0) return false;
+            return length % 2 == 0 || (bytes[whole_bytes] >> 4) == (prefix.bytes[whole_bytes] >> 4);
+        }
+
+        // how many leading hex digits the ids have in common
+        size_t common_hex_digits(const ObjectId &other) const {
+            for (size_t i = 0; i < SIZE; i++) {
+                if (bytes[i] != other.bytes[i]) return 2 * i + ((bytes[i] >> 4) == (other.bytes[i] >> 4));
+            }
+            return HEX_SIZE;
+        }
+
+        static int hex_value(char ch) {
+            if (ch >= '0' && ch <= '9') return ch - '0';
+            if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+            if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+            return -1;
+        }
+
+        bool operator==(const ObjectId &other) const {
+            return std::memcmp(bytes, other.bytes, SIZE) == 0;
+        }
+
+        bool operator!=(const ObjectId &other) const {
+            return !(*this == other);
+        }
+
+        bool operator<(const ObjectId &other) const {
+            return std::memcmp(bytes, other.bytes, SIZE) < 0;
+        }
+    };
+
+    static_assert(std::is_trivially_copyable<ObjectId>::value, "ObjectIds are copied and stored as raw bytes");
+    static_assert(sizeof(ObjectId) == ObjectId::SIZE, "ObjectId has no padding");
+
+    inline std::ostream &operator<<(std::ostream &out, const ObjectId &id) {
+        return out << id.to_hex();
+    }
+
+} // gitc
+
+namespace std {
+    // ids are already uniformly distributed, so their first bytes are a good enough hash
+    template<>
+    struct hash<gitc::ObjectId> {
+        size_t operator()(const gitc::ObjectId &id) const {
+            size_t value;
+            std::memcpy(&value, id.bytes, sizeof value);
+            return value;
+        }
+    };
+}
+
+#endif //GIT_CLONE_OBJECTID_H
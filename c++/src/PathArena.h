@@ -0,0 +1,75 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
+
+#ifndef GIT_CLONE_PATHARENA_H
+#define GIT_CLONE_PATHARENA_H
+
+namespace gitc {
+
+    // append-only storage for the paths of a tree or the index. every path is a slice of one buffer,
+    // so a thousand paths are one allocation instead of a thousand
+    class PathArena {
+    public:
+        struct Path {
+            uint32_t offset;
+            uint32_t length;
+        };
+
+        explicit PathArena(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+                : buffer(resource) {}
+
+        Path add(const char *data, size_t length) {
+            Path path = {(uint32_t) buffer.size(), (uint32_t) length};
+            buffer.append(data, length);
+            return path;
+        }
+
+        Path add(const std::string &path) {
+            return add(path.data(), path.size());
+        }
+
+        std::string get(Path path) const {
+            return std::string(data(path), path.length);
+        }
+
+        const char *data(Path path) const {
+            return buffer.data() + path.offset;
+        }
+
+        bool equals(Path path, const std::string &other) const {
+            return path.length == other.size() && std::memcmp(data(path), other.data(), path.length) == 0;
+        }
+
+        // negative, zero or positive like strcmp
+        int compare(Path path, const char *other, size_t other_length) const {
+            int result = std::memcmp(data(path), other, std::min((size_t) path.length, other_length));
+            if (result != 0) return result;
+            return path.length < other_length ? -1 : path.length > other_length ? 1 : 0;
+        }
+
+        int compare(Path a, Path b) const {
+            return compare(a, data(b), b.length);
+        }
+
+        void reserve(size_t bytes) {
+            buffer.reserve(bytes);
+        }
+
+        void clear() {
+            buffer.clear();
+        }
+
+    private:
+        std::pmr::string buffer;
+    };
+
+} // gitc
+
+#endif //GIT_CLONE_PATHARENA_H
@@ -0,0 +1,74 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <string_view>
+#include <map>
+#include <functional>
+#include <memory_resource>
+#include "Tree.h"
+
+#ifndef GIT_CLONE_PATHRESOLVER_H
+#define GIT_CLONE_PATHRESOLVER_H
+
+namespace gitc {
+
+    // finds what a path points to below one root tree. every tree read on the way is kept under its
+    // directory, so resolving many paths in the same directories reads each tree only once
+    class PathResolver {
+    public:
+        // the cached trees are allocated from resource, which has to outlive the resolver
+        explicit PathResolver(const ObjectId &root_tree_hash,
+                              std::pmr::memory_resource *_resource = std::pmr::get_default_resource())
+                : resource(_resource), trees(_resource) {
+            trees.try_emplace(std::pmr::string(), root_tree_hash, resource);
+        }
+
+        PathResolver(const PathResolver &) = delete;
+        PathResolver &operator=(const PathResolver &) = delete;
+
+        // false if nothing is at path. "" is the root tree itself
+        bool resolve(std::string_view path, Tree::Tree_entry &entry) {
+            while (!path.empty() && path.back() == '/') path.remove_suffix(1);
+
+            if (path.empty()) {
+                entry.hash = directory(path).get_hash();
+                entry.path = path;
+                entry.type = Tree::TREE;
+                return !entry.hash.is_null();
+            }
+
+            const size_t slash = path.rfind('/');
+            if (slash == std::string_view::npos) return directory(std::string_view()).find(path, entry);
+
+            return directory(path.substr(0, slash)).find(path.substr(slash + 1), entry);
+        }
+
+        // the id of the object at path, null if there is none
+        ObjectId resolve(std::string_view path) {
+            Tree::Tree_entry entry;
+            return resolve(path, entry) ? entry.hash : ObjectId();
+        }
+
+    private:
+        std::pmr::memory_resource *resource;
+        std::pmr::map<std::pmr::string, Tree, std::less<>> trees; // directory -> its tree, empty if there's none
+
+        const Tree &directory(std::string_view path) {
+            auto cached = trees.find(path);
+            if (cached != trees.end()) return cached->second;
+
+            Tree::Tree_entry entry;
+            ObjectId hash;
+            if (resolve(path, entry) && entry.type == Tree::TREE) {
+                hash = entry.hash;
+            }
+
+            return trees.try_emplace(std::pmr::string(path, resource), hash, resource).first->second;
+        }
+    };
+
+} // gitc
+
+#endif //GIT_CLONE_PATHRESOLVER_H
@@ -0,0 +1,295 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+#include <algorithm>
+#include <iostream>
+#include "Glob.h"
+
+#ifndef GIT_CLONE_PATHSPEC_H
+#define GIT_CLONE_PATHSPEC_H
+
+namespace gitc {
+
+    // the paths given to add, rm, status and log, compiled once. a path without wildcards matches
+    // itself and everything below it, otherwise it's a glob where * also matches / ("*.h" is every
+    // header). a pathspec can start with magic:
+    //   :(exclude) or :! or :^   leave out what it matches
+    //   :(glob)                  * stops at a /, only ** crosses directories
+    //   :(literal)               no wildcards
+    //   :(icase)                 ignore case
+    //   :(top) or :/             relative to the root, which paths always are
+    // the long forms can be combined, as in ":(exclude,icase)". plain paths are looked up in a hash table,
+    // so a long list of them costs no more than one, and every glob keeps the part before its first
+    // wildcard, so most paths and whole directories are turned down with a string comparison
+    class Pathspec {
+    public:
+        Pathspec() = default;
+
+        explicit Pathspec(const std::vector<std::string> &specs) {
+            for (const std::string &spec: specs) {
+                add_item(spec);
+            }
+
+            for (size_t i = 0; i < items.size(); i++) {
+                Item &item = items[i];
+                if (item.exclude || !item.literal || item.icase || item.pattern.empty()) {
+                    (item.exclude ? excludes : others).push_back(i);
+                    continue;
+                }
+
+                literals[item.pattern].push_back(i);
+                for (size_t slash = item.pattern.find('/'); slash != std::string::npos;
+                     slash = item.pattern.find('/', slash + 1)) {
+                    literal_parents.insert(item.pattern.substr(0, slash));
+                }
+            }
+        }
+
+        // no pathspec at all, everything matches
+        bool is_empty() const {
+            return items.empty();
+        }
+
+        // path is relative to the root, a file or a directory
+        bool matches(std::string_view path) const {
+            if (items.empty()) return true;
+
+            for (size_t i: excludes) {
+                if (item_matches(items[i], path)) return false;
+            }
+
+            // every include is marked, not only the first, so unmatched() is exact
+            bool matched = !has_includes;
+            while (path.compare(0, 2, "./") == 0) path.remove_prefix(2);
+
+            // a literal matches the path or one of the directories it's in
+            for (size_t end = 0; !literals.empty() && end != std::string_view::npos;) {
+                end = path.find('/', end + 1);
+                auto found = literals.find(std::string(path.substr(0, end)));
+                if (found == literals.end()) continue;
+
+                for (size_t i: found->second) used[i] = 1;
+                matched = true;
+            }
+
+            for (size_t i: others) {
+                if (item_matches(items[i], path)) {
+                    used[i] = matched = true;
+                }
+            }
+
+            return matched;
+        }
+
+        // false if nothing below directory can match, so it doesn't have to be read
+        bool may_match_below(std::string_view directory) const {
+            if (items.empty() || directory.empty() || directory == ".") return true;
+            while (directory.compare(0, 2, "./") == 0) directory.remove_prefix(2);
+
+            for (size_t i: excludes) {
+                // only a literal can exclude a whole directory
+                const Item &item = items[i];
+                if (item.literal && !item.icase && is_below(directory, item.pattern)) return false;
+            }
+            if (!has_includes) return true;
+
+            // the directory is a literal or below one, or a literal is below it
+            if (literal_parents.count(std::string(directory))) return true;
+            for (size_t end = 0; !literals.empty() && end != std::string_view::npos;) {
+                end = directory.find('/', end + 1);
+                if (literals.count(std::string(directory.substr(0, end)))) return true;
+            }
+
+            for (size_t i: others) {
+                const Item &item = items[i];
+                const std::string lowered = item.icase ? lower(directory) : std::string();
+                const std::string_view name = item.icase ? std::string_view(lowered) : directory;
+
+                if (item.literal) {
+                    if (is_below(name, item.pattern) || is_below(item.pattern, name)) return true;
+                } else {
+                    // "<directory>/" and the literal prefix must agree as far as both go
+                    const size_t common = std::min(name.size(), item.prefix.size());
+                    if (name.compare(0, common, item.prefix, 0, common) == 0 &&
+                        (item.prefix.size() <= name.size() || item.prefix[name.size()] == '/')) {
+                        return true;
+                    }
+                }
+            }
+
+            return false;
+        }
+
+        // the length of the highest leading directory of path that may_match_below turns down, 0 if none
+        size_t rejected_directory(std::string_view path) const {
+            if (items.empty()) return 0;
+
+            for (size_t slash = path.find('/'); slash != std::string_view::npos; slash = path.find('/', slash + 1)) {
+                if (!may_match_below(path.substr(0, slash))) return slash;
+            }
+
+            return 0;
+        }
+
+        // where a walk has to start: the deepest directory (or file) every include is below
+        std::string walk_root() const {
+            std::string root;
+            bool first = true;
+
+            for (const Item &item: items) {
+                if (item.exclude) continue;
+                if (item.icase) return ".";
+
+                std::string directory = item.literal ? item.pattern : item.prefix.substr(0, item.prefix.rfind('/') + 1);
+                while (!directory.empty() && directory.back() == '/') directory.pop_back();
+
+                if (first) {
+                    root = directory;
+                    first = false;
+                } else {
+                    root = common_directory(root, directory);
+                }
+            }
+
+            return root.empty() ? "." : root;
+        }
+
+        // the path of a pathspec that is one literal path without magic, as the commit graph's path
+        // filters can answer for it
+        bool is_single_path(std::string &path) const {
+            if (items.size() != 1 || items[0].exclude || !items[0].literal || items[0].icase) return false;
+            path = items[0].pattern;
+            return true;
+        }
+
+        // the includes nothing matched so far, as they were given
+        std::vector<std::string> unmatched() const {
+            std::vector<std::string> specs;
+            for (size_t i = 0; i < items.size(); i++) {
+                if (!items[i].exclude && !used[i]) specs.push_back(items[i].spec);
+            }
+            return specs;
+        }
+
+    private:
+        struct Item {
+            std::string spec;    // as given
+            std::string pattern; // without the magic, lower case for icase
+            std::string prefix;  // of the pattern, up to the first wildcard
+            std::string suffix;  // of the pattern, after the last wildcard
+            Glob glob;
+            bool exclude = false;
+            bool literal = false;
+            bool icase = false;
+        };
+
+        std::vector<Item> items;
+        std::unordered_map<std::string, std::vector<size_t>> literals; // plain path -> items
+        std::unordered_set<std::string> literal_parents;              // the directories above them
+        std::vector<size_t> others;   // the includes that aren't in literals
+        std::vector<size_t> excludes;
+        bool has_includes = false;
+        // marked by matches(), for unmatched(). a pathspec is used by one thread at a time
+        mutable std::vector<char> used;
+
+        void add_item(const std::string &spec) {
+            Item item;
+            item.spec = spec;
+            std::string pattern = spec;
+            bool glob_magic = false;
+
+            if (pattern.compare(0, 2, ":(") == 0 && pattern.find(')') != std::string::npos) {
+                const size_t close = pattern.find(')');
+                std::string_view magic = std::string_view(pattern).substr(2, close - 2);
+
+                while (!magic.empty()) {
+                    const size_t comma = std::min(magic.find(','), magic.size());
+                    const std::string_view word = magic.substr(0, comma);
+                    magic.remove_prefix(std::min(comma + 1, magic.size()));
+
+                    if (word == "exclude") item.exclude = true;
+                    else if (word == "glob") glob_magic = true;
+                    else if (word == "literal") item.literal = true;
+                    else if (word == "icase") item.icase = true;
+                    else if (word != "top") std::cout << "warning: unknown pathspec magic '" << word << "'" << std::endl;
+                }
+
+                pattern.erase(0, close + 1);
+            } else if (pattern.size() >= 2 && pattern[0] == ':' && (pattern[1] == '!' || pattern[1] == '^')) {
+                item.exclude = true;
+                pattern.erase(0, 2);
+            } else if (pattern.compare(0, 2, ":/") == 0) {
+                pattern.erase(0, 2);
+            }
+
+            while (pattern.compare(0, 2, "./") == 0) pattern.erase(0, 2);
+            while (!pattern.empty() && pattern.back() == '/') pattern.pop_back();
+            if (pattern == ".") pattern.clear();
+
+            if (item.icase) pattern = lower(pattern);
+            if (!Glob::has_wildcards(pattern)) item.literal = true;
+
+            if (item.literal) {
+                item.prefix = pattern;
+            } else {
+                item.prefix = pattern.substr(0, pattern.find_first_of("*?[\\"));
+                item.suffix = pattern.substr(pattern.find_last_of("*?]\\") + 1);
+                item.glob = Glob(pattern, !glob_magic);
+            }
+
+            item.pattern = std::move(pattern);
+            has_includes |= !item.exclude;
+            items.push_back(std::move(item));
+            used.push_back(false);
+        }
+
+        static bool item_matches(const Item &item, std::string_view path) {
+            while (path.compare(0, 2, "./") == 0) path.remove_prefix(2);
+
+            const std::string lowered = item.icase ? lower(path) : std::string();
+            if (item.icase) path = lowered;
+
+            if (item.literal) return is_below(path, item.pattern);
+
+            // the literal ends turn most paths down before the automaton runs
+            return path.size() >= item.prefix.size() + item.suffix.size() &&
+                   path.compare(0, item.prefix.size(), item.prefix) == 0 &&
+                   path.compare(path.size() - item.suffix.size(), item.suffix.size(), item.suffix) == 0 &&
+                   item.glob.matches(path);
+        }
+
+        // path is directory or somewhere below it, everything is below ""
+        static bool is_below(std::string_view path, std::string_view directory) {
+            return directory.empty() || (path.compare(0, directory.size(), directory) == 0 &&
+                                         (path.size() == directory.size() || path[directory.size()] == '/'));
+        }
+
+        static std::string common_directory(const std::string &a, const std::string &b) {
+            size_t length = 0;
+            for (size_t i = 0; i <= std::min(a.size(), b.size()); i++) {
+                const bool end_a = i == a.size() || a[i] == '/';
+                const bool end_b = i == b.size() || b[i] == '/';
+                if (end_a && end_b) length = i;
+                if (i == a.size() || i == b.size() || a[i] != b[i]) break;
+            }
+            return a.substr(0, length);
+        }
+
+        static std::string lower(std::string_view text) {
+            std::string lowered(text);
+            std::transform(lowered.begin(), lowered.end(), lowered.begin(), [](unsigned char c) {
+                return (char) std::tolower(c);
+            });
+            return lowered;
+        }
+    };
+
+} // gitc
+
+#endif //GIT_CLONE_PATHSPEC_H
@@ -0,0 +1,285 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_set>
+#include <memory>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include "Files.h"
+#include "Tree.h"
+#include "Blob.h"
+#include "CommitGraph.h"
+#include "EwahBitmap.h"
+#include "ObjectDatabase.h"
+#include "ObjectArena.h"
+
+#ifndef GIT_CLONE_REACHABILITYBITMAPS_H
+#define GIT_CLONE_REACHABILITYBITMAPS_H
+
+namespace gitc {
+
+    // every BITMAP_INTERVAL generations (and every tip) gets a bitmap when a pack is written with bitmaps
+    const uint32_t BITMAP_INTERVAL = 64;
+
+    // pack-<name>.bitmap stores, for a few commits, which objects of pack-<name>.pack are reachable from
+    // them (bit i is the i-th id of the pack's sorted index). the objects of any other commit are the
+    // bitmap of its closest ancestor with one, plus what the commits in between add.
+    // each entry is the commit's id, the bitmap's length and the bitmap.
+    class ReachabilityBitmaps {
+    public:
+        // the objects reached so far, a walk can be extended by one commit after another
+        struct Walk {
+            std::vector<uint64_t> bits;           // objects in the pack
+            std::unordered_set<ObjectId> extra;   // reachable objects that aren't in the pack
+            std::vector<ObjectId> *added = nullptr; // gets the objects that weren't in the walk yet, if set
+        };
+
+        explicit ReachabilityBitmaps(ObjectDatabase &db = ObjectDatabase::get()) {
+            RepositoryObjectDatabase *repository = dynamic_cast<RepositoryObjectDatabase *>(&db);
+            if (repository == nullptr) return;
+
+            PackObjectDatabase &packed = repository->get_packed();
+            for (size_t pack = 0; pack < packed.get_packs().size(); pack++) {
+                if (read_from_file(packed.get_packs()[pack] + ".bitmap")) {
+                    pack_ids = packed.get_pack_ids(pack);
+                    break;
+                }
+            }
+        }
+
+        bool available() const {
+            return !bitmaps.empty();
+        }
+
+        // every object (commits, trees and blobs) reachable from the commit
+        void reachable(const ObjectId &commit_hash, std::vector<ObjectId> &objects) {
+            Walk walk;
+            walk_commit(commit_hash, walk);
+
+            for (size_t word = 0; word < walk.bits.size(); word++) {
+                for (uint64_t bits = walk.bits[word]; bits != 0; bits &= bits - 1) {
+                    objects.push_back(pack_ids[word * 64 + __builtin_ctzll(bits)]);
+                }
+            }
+
+            objects.insert(objects.end(), walk.extra.begin(), walk.extra.end());
+        }
+
+        // adds what the commit reaches to walk. the walk stops at commits it already has, so extending one
+        // walk by many commits visits every object once
+        void extend(const ObjectId &commit_hash, Walk &walk) {
+            walk_commit(commit_hash, walk);
+        }
+
+        size_t count(const ObjectId &commit_hash) {
+            Walk walk;
+            walk_commit(commit_hash, walk);
+
+            size_t result = walk.extra.size();
+            for (uint64_t word: walk.bits) {
+                result += __builtin_popcountll(word);
+            }
+
+            return result;
+        }
+
+        // writes pack_name.bitmap for the tips and every BITMAP_INTERVAL-th generation of their history,
+        // every object reachable from the tips has to be in the pack
+        static void write(const std::string &pack_name, const std::vector<ObjectId> &tips) {
+            ReachabilityBitmaps result;
+            CommitGraph graph;
+            std::vector<uint32_t> selected;
+
+            result.pack_ids.clear();
+            result.bitmaps.clear();
+
+            RepositoryObjectDatabase *repository = dynamic_cast<RepositoryObjectDatabase *>(&ObjectDatabase::get());
+            if (repository == nullptr) return;
+
+            PackObjectDatabase &packed = repository->get_packed();
+            for (size_t pack = 0; pack < packed.get_packs().size(); pack++) {
+                if (packed.get_packs()[pack] == pack_name) result.pack_ids = packed.get_pack_ids(pack);
+            }
+
+            for (const ObjectId &tip: tips) {
+                uint32_t position;
+                if (!graph.lookup_or_import(tip, position)) continue;
+
+                selected.push_back(position);
+                for (; position != CommitGraph::NO_PARENT; position = graph.at(position).parent) {
+                    if (graph.at(position).generation % BITMAP_INTERVAL == 0) selected.push_back(position);
+                }
+            }
+
+            // oldest first, so every walk stops at the bitmap selected before it
+            std::sort(selected.begin(), selected.end(), [&graph](uint32_t a, uint32_t b) {
+                return graph.at(a).generation < graph.at(b).generation;
+            });
+            selected.erase(std::unique(selected.begin(), selected.end()), selected.end());
+
+            std::string data = MAGIC;
+            append_int<uint32_t>(data, 0);
+
+            uint32_t count = 0;
+            for (uint32_t position: selected) {
+                const ObjectId commit_hash = CommitGraph::get_commit_hash(graph.at(position));
+                if (result.bitmaps.count(commit_hash)) continue;
+
+                Walk walk;
+                result.walk_commit(commit_hash, walk, graph);
+                result.bitmaps[commit_hash] = EwahBitmap::compress(walk.bits);
+
+                const std::string bitmap = result.bitmaps[commit_hash].serialize();
+                data.append(reinterpret_cast<const char *>(commit_hash.bytes), ObjectId::SIZE);
+                append_int<uint32_t>(data, (uint32_t) bitmap.size());
+                data += bitmap;
+                count++;
+            }
+
+            std::memcpy(&data[4], &count, sizeof count);
+            Durability::write_file(pack_name + ".bitmap", data);
+        }
+
+    private:
+        static constexpr const char *MAGIC = "GBMP";
+
+        std::vector<ObjectId> pack_ids;
+        std::map<ObjectId, EwahBitmap> bitmaps;
+        std::unique_ptr<CommitGraph> graph; // read on the first walk, and kept for the next ones
+
+        template<typename T>
+        static void append_int(std::string &out, T value) {
+            out.append(reinterpret_cast<const char *>(&value), sizeof value);
+        }
+
+        // returns false if the object was already in the walk
+        bool add(const ObjectId &hash, Walk &walk) const {
+            auto it = std::lower_bound(pack_ids.begin(), pack_ids.end(), hash);
+
+            if (it == pack_ids.end() || *it != hash) {
+                if (!walk.extra.insert(hash).second) return false;
+                if (walk.added != nullptr) walk.added->push_back(hash);
+                return true;
+            }
+
+            const size_t position = it - pack_ids.begin();
+            if (walk.bits.size() <= position / 64) walk.bits.resize(pack_ids.size() / 64 + 1, 0);
+            if (walk.bits[position / 64] >> (position % 64) & 1) return false;
+
+            walk.bits[position / 64] |= (uint64_t) 1 << (position % 64);
+            if (walk.added != nullptr) walk.added->push_back(hash);
+            return true;
+        }
+
+        bool contains(const ObjectId &hash, const Walk &walk) const {
+            auto it = std::lower_bound(pack_ids.begin(), pack_ids.end(), hash);
+            if (it == pack_ids.end() || *it != hash) return walk.extra.count(hash) != 0;
+
+            const size_t position = it - pack_ids.begin();
+            return position / 64 < walk.bits.size() && (walk.bits[position / 64] >> (position % 64) & 1);
+        }
+
+        void walk_commit(const ObjectId &commit_hash, Walk &walk) {
+            if (!graph) graph.reset(new CommitGraph());
+            walk_commit(commit_hash, walk, *graph);
+        }
+
+        void walk_commit(const ObjectId &commit_hash, Walk &walk, CommitGraph &graph) {
+            uint32_t position;
+            if (!graph.lookup_or_import(commit_hash, position)) return;
+
+            // find the closest ancestor with a bitmap, the commits up to it are walked by hand. a commit
+            // that is in the walk already came with everything it reaches
+            std::vector<uint32_t> between;
+            for (; position != CommitGraph::NO_PARENT; position = graph.at(position).parent) {
+                const ObjectId &hash = CommitGraph::get_commit_hash(graph.at(position));
+                if (contains(hash, walk)) break;
+
+                auto bitmap = bitmaps.find(hash);
+                if (bitmap != bitmaps.end()) {
+                    or_into(bitmap->second, walk);
+                    break;
+                }
+
+                between.push_back(position);
+            }
+
+            // the trees of one commit are parsed into the arena, which is released before the next commit
+            ObjectArena arena;
+            for (uint32_t commit: between) {
+                arena.release();
+                add(CommitGraph::get_commit_hash(graph.at(commit)), walk);
+                walk_tree(CommitGraph::get_tree_hash(graph.at(commit)), walk, arena.get());
+            }
+        }
+
+        void or_into(const EwahBitmap &bitmap, Walk &walk) const {
+            if (walk.added == nullptr) {
+                bitmap.or_into(walk.bits);
+                return;
+            }
+
+            std::vector<size_t> positions;
+            bitmap.or_into(walk.bits, &positions);
+            for (size_t position: positions) {
+                if (position < pack_ids.size()) walk.added->push_back(pack_ids[position]);
+            }
+        }
+
+        // trees already in the walk were walked before (or come from a bitmap), so their contents are too
+        void walk_tree(const ObjectId &tree_hash, Walk &walk, std::pmr::memory_resource *resource) const {
+            if (tree_hash.is_null() || !add(tree_hash, walk)) return;
+
+            Tree tree(tree_hash, resource);
+            for (const Tree::Tree_entry &entry: tree) {
+                if (entry.type == Tree::TREE) {
+                    walk_tree(entry.hash, walk, resource);
+                } else if (entry.type == Tree::CHUNKED && add(entry.hash, walk)) {
+                    std::vector<ObjectId> chunks;
+                    Blob::read_chunks(entry.hash, chunks);
+                    for (const ObjectId &chunk: chunks) {
+                        add(chunk, walk);
+                    }
+                } else {
+                    add(entry.hash, walk);
+                }
+            }
+        }
+
+        bool read_from_file(const std::string &path) {
+            std::string data;
+            if (!Files::read_file(path, data) || data.compare(0, 4, MAGIC) != 0) return false;
+
+            size_t pos = 4;
+            uint32_t count = read_int<uint32_t>(data, pos);
+
+            for (uint32_t i = 0; i < count && pos + ObjectId::SIZE <= data.size(); i++) {
+                ObjectId commit_hash;
+                std::memcpy(commit_hash.bytes, data.data() + pos, ObjectId::SIZE);
+                pos += ObjectId::SIZE;
+
+                uint32_t bitmap_length = read_int<uint32_t>(data, pos);
+                bitmaps[commit_hash] = EwahBitmap::deserialize(data.substr(pos, bitmap_length));
+                pos += bitmap_length;
+            }
+
+            return true;
+        }
+
+        template<typename T>
+        static T read_int(const std::string &in, size_t &pos) {
+            T value = 0;
+            if (pos + sizeof value <= in.size()) std::memcpy(&value, in.data() + pos, sizeof value);
+            pos += sizeof value;
+            return value;
+        }
+    };
+
+} // gitc
+
+#endif //GIT_CLONE_REACHABILITYBITMAPS_H
@@ -0,0 +1,255 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <ctime>
+#include <cerrno>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include "Files.h"
+#include "ObjectId.h"
+#include "Durability.h"
+
+#ifndef GIT_CLONE_REFLOG_H
+#define GIT_CLONE_REFLOG_H
+
+namespace gitc {
+
+    // reflog entries younger than this keep their commits alive through gc, older ones are expired
+    const long REFLOG_EXPIRE = 30 * 24 * 60 * 60;
+
+    // message points into the mapped log, it's only valid while the entry is visited
+    struct Reflog_entry {
+        ObjectId old_hash;
+        ObjectId new_hash;
+        unsigned long timestamp;
+        std::string_view message;
+    };
+
+    // every value a ref had, in two append-only files per ref, each kind in its own tree so no ref name
+    // can stand for another ref's file:
+    //   .gitc/logs/records/<ref>   "GRLG" and a version, then one fixed-size record per move, oldest first
+    //   .gitc/logs/messages/<ref>  the messages back to back, each record has the offset and length of its own
+    // an append writes at the end of both files (O_APPEND) and reads neither. records are in time order,
+    // so a scan from the end stops at the first entry it doesn't need, and expiry finds the first entry to
+    // keep with a binary search and copies only what follows it. the expired messages become a hole at the
+    // start of the new messages file, so the offsets in the records never change
+    class Reflog {
+    public:
+        // the caller holds the ref's lock (see Refs), so appends and expiry never interleave.
+        // false if the entry wasn't written whole
+        static bool append(const std::string &ref, const ObjectId &old_hash, const ObjectId &new_hash,
+                           std::string_view message) {
+            const int messages = open_for_append(messages_path(ref), "");
+            const int records = open_for_append(records_path(ref), std::string_view(HEADER, HEADER_SIZE));
+            bool appended = false;
+
+            // nobody else appends while the ref is locked, so the message ends where the file does. a torn
+            // record is cut off first, or this one and every later one would be misaligned
+            if (messages >= 0 && records >= 0 && cut_torn_record(records) && write_all(messages, message)) {
+                const Reflog_record record = {old_hash, new_hash, (uint64_t) time(nullptr),
+                                              (uint64_t) lseek(messages, 0, SEEK_END) - message.size(),
+                                              (uint32_t) message.size(), 0};
+                appended = write_all(records, std::string_view(reinterpret_cast<const char *>(&record), sizeof record));
+            }
+
+            if (messages >= 0) close(messages);
+            if (records >= 0) close(records);
+            return appended;
+        }
+
+        // takes back the entry append just wrote, when the ref couldn't be moved after all. the caller
+        // still holds the ref's lock, so it is the last record
+        static void remove_last(const std::string &ref) {
+            const std::string path = records_path(ref);
+            const unsigned long long size = Files::file_size(path);
+            if (size < HEADER_SIZE + sizeof(Reflog_record)) return;
+
+            const size_t records = (size - HEADER_SIZE) / sizeof(Reflog_record);
+            Files::truncate_file(path, HEADER_SIZE + (records - 1) * sizeof(Reflog_record));
+        }
+
+        // calls visit(const Reflog_entry &) for the entries of ref, newest first, until it returns false
+        template<typename Visit>
+        static void scan_reverse(const std::string &ref, Visit &&visit) {
+
+            const MappedFile records(records_path(ref)), messages(messages_path(ref));
+            const std::string_view data = records.get(), text = messages.get();
+            if (!is_valid(data)) return;
+
+            // a torn last record, from a crash in the middle of an append, is left out, and cut off by the next append
+            for (size_t i = record_count(data); i-- > 0;) {
+                const Reflog_record record = record_at(data, i);
+                const bool has_message = record.message_offset + record.message_length <= text.size();
+
+                const Reflog_entry entry = {record.old_hash, record.new_hash, (unsigned long) record.timestamp,
+                                            has_message ? text.substr(record.message_offset, record.message_length)
+                                                        : std::string_view()};
+                if (!visit(entry)) return;
+            }
+        }
+
+        // drops the entries older than expire_time and returns how many, the caller holds the ref's lock
+        static size_t expire(const std::string &ref, time_t expire_time) {
+
+            const std::string path = records_path(ref);
+            const MappedFile records(path), messages(messages_path(ref));
+            const std::string_view data = records.get(), text = messages.get();
+            if (!is_valid(data)) return 0;
+
+            const size_t count = record_count(data);
+            size_t low = 0, high = count;
+            while (low < high) {
+                const size_t middle = low + (high - low) / 2;
+                if ((time_t) record_at(data, middle).timestamp < expire_time) {
+                    low = middle + 1;
+                } else {
+                    high = middle;
+                }
+            }
+            if (low == 0) return 0;
+
+            if (low == count) {
+                remove(ref);
+                return count;
+            }
+
+            // the records go first: until the messages are replaced too, the old file still has every message
+            const size_t base = std::min((size_t) record_at(data, low).message_offset, text.size());
+            std::string kept(HEADER, HEADER_SIZE);
+            kept += data.substr(HEADER_SIZE + low * sizeof(Reflog_record), (count - low) * sizeof(Reflog_record));
+
+            if (!write_from(path, kept, 0) || !write_from(messages_path(ref), text, base)) return 0;
+            return low;
+        }
+
+        static void remove(const std::string &ref) {
+            Files::delete_file(records_path(ref));
+            Files::delete_file(messages_path(ref));
+        }
+
+        // the refs with a reflog
+        static std::vector<std::string> list_refs() {
+            std::vector<std::string> refs;
+            const std::string records = Files::join_path(logs_dir(), RECORDS_DIR);
+
+            // a ".." can't be in a ref name, only in a temporary file
+            Files::walk_files(records, [&refs, &records](std::string &&path) {
+                std::string ref = path.substr(records.size() + 1);
+                if (ref.find("..") == std::string::npos) refs.push_back(std::move(ref));
+            });
+
+            return refs;
+        }
+
+    private:
+        struct Reflog_record {
+            ObjectId old_hash;       // null when the ref was created
+            ObjectId new_hash;
+            uint64_t timestamp;
+            uint64_t message_offset; // in the messages file
+            uint32_t message_length;
+            uint32_t reserved;
+        };
+
+        static_assert(std::is_trivially_copyable<Reflog_record>::value, "reflog records are memcpy'd");
+        static_assert(sizeof(Reflog_record) == 2 * ObjectId::SIZE + 24, "reflog records have no padding");
+
+        static constexpr const char *HEADER = "GRLG\x01\0\0\0";
+        static const size_t HEADER_SIZE = 8;
+        static constexpr const char *RECORDS_DIR = "records";
+        static constexpr const char *MESSAGES_DIR = "messages";
+
+        static std::string logs_dir() {
+            return Files::join_path(Files::root_path(), ".gitc/logs");
+        }
+
+        static std::string records_path(const std::string &ref) {
+            return Files::join_path(Files::join_path(logs_dir(), RECORDS_DIR), ref);
+        }
+
+        static std::string messages_path(const std::string &ref) {
+            return Files::join_path(Files::join_path(logs_dir(), MESSAGES_DIR), ref);
+        }
+
+        // next to path, with a name no ref can have, so list_refs never takes it for one
+        static int make_temporary(const std::string &path, std::string &temp_path) {
+            return Files::create_temp_file(path, "..", temp_path);
+        }
+
+        static bool is_valid(std::string_view data) {
+            return data.size() >= HEADER_SIZE && data.compare(0, HEADER_SIZE, std::string_view(HEADER, HEADER_SIZE)) == 0;
+        }
+
+        static size_t record_count(std::string_view data) {
+            return (data.size() - HEADER_SIZE) / sizeof(Reflog_record);
+        }
+
+        static Reflog_record record_at(std::string_view data, size_t i) {
+            Reflog_record record;
+            std::memcpy(&record, data.data() + HEADER_SIZE + i * sizeof(Reflog_record), sizeof record);
+            return record;
+        }
+
+        // a new file starts out with header, it's linked into place whole so no append lands before it
+        static int open_for_append(const std::string &path, std::string_view header) {
+            int fd = open(path.c_str(), O_WRONLY | O_APPEND);
+            if (fd >= 0 || errno != ENOENT) return fd;
+
+            Files::make_parent_dirs(path);
+            std::string temp_path;
+            const int temp = make_temporary(path, temp_path);
+            if (temp < 0) return -1;
+
+            const bool written = write_all(temp, header);
+            close(temp);
+            if (written) link(temp_path.c_str(), path.c_str());
+            unlink(temp_path.c_str());
+
+            return open(path.c_str(), O_WRONLY | O_APPEND);
+        }
+
+        static bool write_all(int fd, std::string_view content) {
+            for (size_t done = 0; done < content.size();) {
+                const ssize_t count = ::write(fd, content.data() + done, content.size() - done);
+                if (count <= 0) return false;
+                done += (size_t) count;
+            }
+            return true;
+        }
+
+        static bool cut_torn_record(int fd) {
+            struct stat info;
+            if (fstat(fd, &info) != 0 || (size_t) info.st_size < HEADER_SIZE) return false;
+
+            const size_t records = ((size_t) info.st_size - HEADER_SIZE) / sizeof(Reflog_record);
+            const size_t size = HEADER_SIZE + records * sizeof(Reflog_record);
+            return size == (size_t) info.st_size || ftruncate(fd, (off_t) size) == 0;
+        }
+
+        // replaces path with text from offset start on, at the same offset: what's before is a hole
+        static bool write_from(const std::string &path, std::string_view text, size_t start) {
+            std::string temp_path;
+            const int fd = make_temporary(path, temp_path);
+            if (fd < 0) return false;
+
+            const bool written = ftruncate(fd, (off_t) start) == 0 && lseek(fd, (off_t) start, SEEK_SET) >= 0 &&
+                                 write_all(fd, text.substr(start));
+            close(fd);
+
+            if (written && Durability::rename_file(temp_path, path)) return true;
+
+            unlink(temp_path.c_str());
+            return false;
+        }
+    };
+
+} // gitc
+
+#endif //GIT_CLONE_REFLOG_H
@@ -0,0 +1,293 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <memory>
+#include <iostream>
+#include "Files.h"
+#include "ObjectId.h"
+#include "LockFile.h"
+#include "Reflog.h"
+
+#ifndef GIT_CLONE_REFS_H
+#define GIT_CLONE_REFS_H
+
+namespace gitc {
+
+    // branches (refs/heads/<name>) and tags (refs/tags/<name>). a ref is a loose file, .gitc/<ref> with
+    // its id, or a line of .gitc/packed-refs, which holds the packed refs sorted by name:
+    //   # pack-refs with: sorted
+    //   <64 hex digits> <ref>
+    // a ref is found with one open and a binary search of the mapped file, and listing the refs below a
+    // prefix reads that range and the prefix's own directory, which pack() empties. a loose ref wins over
+    // its packed line. every change holds <file>.lock, created exclusively, and is renamed into place
+    // from it, so two commands never lose each other's updates. the lock of a ref also guards its reflog
+    class Refs {
+    public:
+        struct Ref {
+            std::string name;
+            ObjectId hash;
+        };
+
+        static constexpr std::string_view BRANCH_PREFIX = "refs/heads/";
+        static constexpr std::string_view TAG_PREFIX = "refs/tags/";
+
+        static Refs &get() {
+            static Refs refs;
+            return refs;
+        }
+
+        // false if the ref doesn't exist, or is a branch without commits yet
+        bool read(const std::string &ref, ObjectId &hash) {
+            std::string content;
+            if (Files::read_file(loose_path(ref), content)) {
+                hash = ObjectId::from_hex(std::string_view(content).substr(0, ObjectId::HEX_SIZE));
+                return !hash.is_null();
+            }
+
+            const char *line = find_packed(ref);
+            if (line == nullptr) return false;
+
+            hash = ObjectId::from_hex(std::string_view(line, ObjectId::HEX_SIZE));
+            return !hash.is_null();
+        }
+
+        // the ref a name given on the command line stands for: a full ref name, a tag or a branch
+        bool resolve(const std::string &name, std::string &ref, ObjectId &hash) {
+            for (const std::string &candidate: {name, std::string(TAG_PREFIX) + name, std::string(BRANCH_PREFIX) + name}) {
+                if (candidate.compare(0, 5, "refs/") == 0 && is_valid_name(candidate) && read(candidate, hash)) {
+                    ref = candidate;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // points ref at hash, if it still points at expected (null: if it doesn't exist). the move is
+        // recorded in the ref's reflog, under the same lock, and taken back if the ref can't be written:
+        // revert trusts the reflog to only have commits the ref really pointed to
+        bool update(const std::string &ref, const ObjectId &hash, const ObjectId &expected,
+                    std::string_view reflog_message) {
+            LockFile lock(loose_path(ref));
+            if (!lock.is_locked()) return false;
+
+            ObjectId current;
+            read(ref, current);
+            if (current != expected) {
+                std::cout << "fatal: cannot lock ref '" << ref << "': it moved to " << current.to_hex()
+                          << " in the meantime" << std::endl;
+                return false;
+            }
+
+            const bool logged = Reflog::append(ref, expected, hash, reflog_message);
+            if (lock.commit(hash.to_hex() + "\n", loose_path(ref))) return true;
+
+            // the ref didn't move, unless only syncing its directory failed
+            ObjectId moved;
+            if (logged && lock.is_locked() && !(read(ref, moved) && moved == hash)) Reflog::remove_last(ref);
+            return false;
+        }
+
+        // deletes the loose file and the packed line of ref, and its reflog
+        bool remove(const std::string &ref) {
+            LockFile lock(loose_path(ref));
+            if (!lock.is_locked()) return false;
+
+            if (find_packed(ref) != nullptr) {
+                LockFile packed_lock(packed_path());
+                if (!packed_lock.is_locked()) return false;
+
+                // reloaded under the lock, the line is cut out of it as it is now
+                load_packed();
+                const char *line = find_packed(ref);
+                if (line != nullptr) {
+                    const std::string_view content = packed->get();
+                    const size_t start = line - content.data();
+                    const size_t end = content.find('\n', start);
+
+                    std::string rewritten(content.substr(0, start));
+                    if (end != std::string_view::npos) rewritten += content.substr(end + 1);
+                    if (!packed_lock.commit(rewritten, packed_path())) return false;
+                    packed.reset();
+                }
+            }
+
+            Files::delete_file(loose_path(ref));
+            Reflog::remove(ref);
+            return true;
+        }
+
+        // the refs whose name starts with prefix, sorted by name
+        std::vector<Ref> list(const std::string &prefix) {
+            std::map<std::string, ObjectId> refs;
+
+            const std::string_view content = get_packed();
+            for (size_t start = lower_bound(prefix); start < content.size();) {
+                const size_t end = std::min(content.find('\n', start), content.size());
+
+                // a line too short for an id and a name, from a truncated or hand-edited file, is skipped
+                if (end - start > ObjectId::HEX_SIZE + 1) {
+                    const std::string_view name = content.substr(start + ObjectId::HEX_SIZE + 1,
+                                                                 end - start - ObjectId::HEX_SIZE - 1);
+                    if (name.compare(0, prefix.size(), prefix) != 0) break;
+
+                    refs[std::string(name)] = ObjectId::from_hex(content.substr(start, ObjectId::HEX_SIZE));
+                }
+                start = end + 1;
+            }
+
+            Files::walk_files(Files::join_path(gitc_dir, prefix), [this, &refs](std::string &&path) {
+                if (path.size() > 5 && path.compare(path.size() - 5, 5, ".lock") == 0) return;
+
+                std::string content;
+                const std::string name = path.substr(gitc_dir.size() + 1);
+                if (!Files::read_file(path, content)) return;
+                refs[name] = ObjectId::from_hex(std::string_view(content).substr(0, ObjectId::HEX_SIZE));
+            });
+
+            std::vector<Ref> result;
+            for (auto &ref: refs) {
+                if (!ref.second.is_null() && ref.first.compare(0, prefix.size(), prefix) == 0) {
+                    result.push_back({ref.first, ref.second});
+                }
+            }
+            return result;
+        }
+
+        // moves every loose ref into packed-refs, returns how many refs are packed
+        size_t pack() {
+            LockFile packed_lock(packed_path());
+            if (!packed_lock.is_locked()) return 0;
+
+            load_packed();
+            const std::vector<Ref> refs = list("refs/");
+
+            std::string content = PACKED_HEADER;
+            for (const Ref &ref: refs) {
+                content += ref.hash.to_hex() + " " + ref.name + "\n";
+            }
+            if (!packed_lock.commit(content, packed_path())) return 0;
+            packed.reset();
+
+            // a loose ref is only deleted if nobody moved it since it was packed
+            for (const Ref &ref: refs) {
+                LockFile lock(loose_path(ref.name));
+                std::string loose;
+                if (lock.is_locked() && Files::read_file(loose_path(ref.name), loose) &&
+                    ObjectId::from_hex(std::string_view(loose).substr(0, ObjectId::HEX_SIZE)) == ref.hash) {
+                    Files::delete_file(loose_path(ref.name));
+                }
+            }
+
+            return refs.size();
+        }
+
+        // drops the reflog entries older than expire_time, each reflog under its ref's lock
+        size_t expire_reflogs(time_t expire_time) {
+            size_t expired = 0;
+            for (const std::string &ref: Reflog::list_refs()) {
+                LockFile lock(loose_path(ref));
+                if (lock.is_locked()) expired += Reflog::expire(ref, expire_time);
+            }
+            return expired;
+        }
+
+        // a branch or tag name: no "..", no "//", no control characters or ~^:?*[\ and space, doesn't
+        // start with - or ., nor end with / or .lock
+        static bool is_valid_name(const std::string &name) {
+            if (name.empty() || name[0] == '-' || name[0] == '.' || name[0] == '/' || name.back() == '/' ||
+                name.back() == '.' || name.find("..") != std::string::npos || name.find("//") != std::string::npos ||
+                name.find("/.") != std::string::npos || name.find("@{") != std::string::npos ||
+                (name.size() >= 5 && name.compare(name.size() - 5, 5, ".lock") == 0)) {
+                return false;
+            }
+
+            for (const char c: name) {
+                if ((unsigned char) c < 0x20 || c == 0x7f || std::string_view(" ~^:?*[\\").find(c) != std::string_view::npos) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    private:
+        static constexpr const char *PACKED_HEADER = "# pack-refs with: sorted\n";
+
+        std::string gitc_dir;
+        std::unique_ptr<MappedFile> packed;
+
+        Refs() : gitc_dir(Files::join_path(Files::root_path(), ".gitc")) {}
+
+        std::string loose_path(const std::string &ref) const {
+            return Files::join_path(gitc_dir, ref);
+        }
+
+        std::string packed_path() const {
+            return Files::join_path(gitc_dir, "packed-refs");
+        }
+
+        void load_packed() {
+            packed.reset(new MappedFile(packed_path()));
+        }
+
+        // the records of packed-refs, without the header
+        std::string_view get_packed() {
+            if (!packed) load_packed();
+
+            std::string_view content = packed->get();
+            if (content.compare(0, 1, "#") == 0) {
+                const size_t end = content.find('\n');
+                content.remove_prefix(end == std::string_view::npos ? content.size() : end + 1);
+            }
+            return content;
+        }
+
+        // the offset in get_packed() of the first line whose ref isn't before name. lines differ in length,
+        // so the search halves a byte range, and moves from the middle back to the start of its line
+        size_t lower_bound(std::string_view name) {
+            const std::string_view content = get_packed();
+            size_t low = 0, high = content.size();
+
+            while (low < high) {
+                const size_t middle = low + (high - low) / 2;
+                size_t start = middle;
+                while (start > low && content[start - 1] != '\n') start--;
+
+                const size_t end = std::min(content.find('\n', start), content.size());
+                const std::string_view ref = end - start > ObjectId::HEX_SIZE + 1
+                                             ? content.substr(start + ObjectId::HEX_SIZE + 1,
+                                                              end - start - ObjectId::HEX_SIZE - 1)
+                                             : std::string_view();
+
+                if (ref < name) {
+                    low = end + 1;
+                } else {
+                    high = start;
+                }
+            }
+
+            return std::min(low, content.size());
+        }
+
+        // the start of ref's line in the mapped packed-refs, nullptr if it isn't packed
+        const char *find_packed(std::string_view ref) {
+            const std::string_view content = get_packed();
+            const size_t start = lower_bound(ref);
+            if (start >= content.size()) return nullptr;
+
+            const size_t end = std::min(content.find('\n', start), content.size());
+            if (end - start <= ObjectId::HEX_SIZE + 1 ||
+                content.substr(start + ObjectId::HEX_SIZE + 1, end - start - ObjectId::HEX_SIZE - 1) != ref) {
+                return nullptr;
+            }
+            return content.data() + start;
+        }
+    };
+
+} // gitc
+
+#endif //GIT_CLONE_REFS_H
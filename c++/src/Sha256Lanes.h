@@ -0,0 +1,202 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string_view>
+#include <cstdint>
+#include <cstring>
+#include "ObjectId.h"
+#include "Sha256.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GITC_SHA256_LANES_AVX2
+#endif
+
+#ifndef GIT_CLONE_SHA256LANES_H
+#define GIT_CLONE_SHA256LANES_H
+
+namespace gitc {
+
+    // multi-buffer SHA-256: hashes many independent inputs at once, one per 32-bit lane of an AVX2
+    // register, so 8 small files cost about as much as one. a lane that finishes its input takes the next
+    // one right away, so inputs of different lengths don't leave lanes idle. the AVX2 code is picked at run
+    // time, other CPUs hash one input after the other
+    class Sha256Lanes {
+    public:
+        static const size_t LANES = 8;
+
+        // ids[i] is the hash of inputs[i]
+        static void hash_many(const std::string_view *inputs, size_t count, ObjectId *ids) {
+#ifdef GITC_SHA256_LANES_AVX2
+            if (count > 1 && has_avx2()) {
+                hash_avx2(inputs, count, ids);
+                return;
+            }
+#endif
+            for (size_t i = 0; i < count; i++) {
+                ids[i] = Sha256::hash(inputs[i]);
+            }
+        }
+
+    private:
+        // the padded input of one lane: its whole blocks are read in place, the padded rest from tail
+        struct Lane {
+            const unsigned char *data = nullptr;
+            size_t full_blocks = 0, blocks = 0, position = 0;
+            size_t input = 0;
+            bool active = false;
+            unsigned char tail[128];
+
+            void start(std::string_view content, size_t _input) {
+                const size_t rest = content.size() % 64;
+                const uint64_t length_in_bits = (uint64_t) content.size() * 8;
+
+                data = reinterpret_cast<const unsigned char *>(content.data());
+                full_blocks = content.size() / 64;
+                blocks = full_blocks + (rest < 56 ? 1 : 2);
+                position = 0;
+                input = _input;
+                active = true;
+
+                std::memset(tail, 0, sizeof tail);
+                if (rest > 0) std::memcpy(tail, data + full_blocks * 64, rest);
+                tail[rest] = 0x80;
+
+                unsigned char *length = tail + (blocks - full_blocks) * 64 - 8;
+                for (int i = 0; i < 8; i++) length[i] = (unsigned char) (length_in_bits >> (56 - 8 * i));
+            }
+
+            const unsigned char *block() const {
+                return position < full_blocks ? data + position * 64 : tail + (position - full_blocks) * 64;
+            }
+        };
+
+#ifdef GITC_SHA256_LANES_AVX2
+        static bool has_avx2() {
+            static const bool supported = __builtin_cpu_supports("avx2");
+            return supported;
+        }
+
+        __attribute__((target("avx2")))
+        static void hash_avx2(const std::string_view *inputs, size_t count, ObjectId *ids) {
+            static const uint32_t initial_state[8] = {
+                    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+            };
+            static const unsigned char idle_block[64] = {};
+
+            Lane lanes[LANES];
+            alignas(32) uint32_t state[8][LANES]; // word, lane
+            size_t next = 0, active = 0;
+
+            for (size_t lane = 0; lane < LANES && next < count; lane++, active++) {
+                lanes[lane].start(inputs[next], next);
+                next++;
+                for (int word = 0; word < 8; word++) state[word][lane] = initial_state[word];
+            }
+
+            while (active > 0) {
+                const unsigned char *blocks[LANES];
+                for (size_t lane = 0; lane < LANES; lane++) {
+                    blocks[lane] = lanes[lane].active ? lanes[lane].block() : idle_block;
+                }
+
+                process_blocks(state, blocks);
+
+                for (size_t lane = 0; lane < LANES; lane++) {
+                    Lane &current = lanes[lane];
+                    if (!current.active || ++current.position < current.blocks) continue;
+
+                    ObjectId &id = ids[current.input];
+                    for (int word = 0; word < 8; word++) {
+                        for (int j = 0; j < 4; j++) id.bytes[4 * word + j] = (unsigned char) (state[word][lane] >> (24 - 8 * j));
+                    }
+
+                    if (next < count) {
+                        current.start(inputs[next], next);
+                        next++;
+                        for (int word = 0; word < 8; word++) state[word][lane] = initial_state[word];
+                    } else {
+                        current.active = false;
+                        active--;
+                    }
+                }
+            }
+        }
+
+        template<int N>
+        __attribute__((target("avx2")))
+        static __m256i rotr(__m256i x) {
+            return _mm256_or_si256(_mm256_srli_epi32(x, N), _mm256_slli_epi32(x, 32 - N));
+        }
+
+        // one compression per lane, lane i compresses blocks[i] into state[.][i]
+        __attribute__((target("avx2")))
+        static void process_blocks(uint32_t state[8][LANES], const unsigned char *const blocks[LANES]) {
+            static const uint32_t K[64] = {
+                    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+                    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+                    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+                    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+                    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+                    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+                    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+                    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+            };
+
+            __m256i w[64];
+            for (int i = 0; i < 16; i++) {
+                uint32_t words[LANES];
+                for (size_t lane = 0; lane < LANES; lane++) {
+                    uint32_t word;
+                    std::memcpy(&word, blocks[lane] + 4 * i, sizeof word);
+                    words[lane] = __builtin_bswap32(word);
+                }
+                w[i] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words));
+            }
+
+            for (int i = 16; i < 64; i++) {
+                const __m256i s0 = _mm256_xor_si256(_mm256_xor_si256(rotr<7>(w[i - 15]), rotr<18>(w[i - 15])),
+                                                    _mm256_srli_epi32(w[i - 15], 3));
+                const __m256i s1 = _mm256_xor_si256(_mm256_xor_si256(rotr<17>(w[i - 2]), rotr<19>(w[i - 2])),
+                                                    _mm256_srli_epi32(w[i - 2], 10));
+                w[i] = _mm256_add_epi32(_mm256_add_epi32(w[i - 16], s0), _mm256_add_epi32(w[i - 7], s1));
+            }
+
+            __m256i v[8];
+            for (int word = 0; word < 8; word++) {
+                v[word] = _mm256_load_si256(reinterpret_cast<const __m256i *>(state[word]));
+            }
+            __m256i a = v[0], b = v[1], c = v[2], d = v[3], e = v[4], f = v[5], g = v[6], h = v[7];
+
+            for (int i = 0; i < 64; i++) {
+                const __m256i sigma1 = _mm256_xor_si256(_mm256_xor_si256(rotr<6>(e), rotr<11>(e)), rotr<25>(e));
+                const __m256i choose = _mm256_xor_si256(_mm256_and_si256(e, f), _mm256_andnot_si256(e, g));
+                const __m256i t1 = _mm256_add_epi32(_mm256_add_epi32(_mm256_add_epi32(h, sigma1), choose),
+                                                    _mm256_add_epi32(_mm256_set1_epi32((int) K[i]), w[i]));
+                const __m256i sigma0 = _mm256_xor_si256(_mm256_xor_si256(rotr<2>(a), rotr<13>(a)), rotr<22>(a));
+                const __m256i majority = _mm256_xor_si256(_mm256_xor_si256(_mm256_and_si256(a, b), _mm256_and_si256(a, c)),
+                                                          _mm256_and_si256(b, c));
+                const __m256i t2 = _mm256_add_epi32(sigma0, majority);
+
+                h = g;
+                g = f;
+                f = e;
+                e = _mm256_add_epi32(d, t1);
+                d = c;
+                c = b;
+                b = a;
+                a = _mm256_add_epi32(t1, t2);
+            }
+
+            const __m256i result[8] = {a, b, c, d, e, f, g, h};
+            for (int word = 0; word < 8; word++) {
+                _mm256_store_si256(reinterpret_cast<__m256i *>(state[word]), _mm256_add_epi32(v[word], result[word]));
+            }
+        }
+#endif
+    };
+
+} // gitc
+
+#endif //GIT_CLONE_SHA256LANES_H
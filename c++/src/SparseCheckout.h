@@ -0,0 +1,121 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <algorithm>
+#include "Files.h"
+#include "Durability.h"
+
+#ifndef GIT_CLONE_SPARSECHECKOUT_H
+#define GIT_CLONE_SPARSECHECKOUT_H
+
+namespace gitc {
+
+    // the directory cones of a sparse checkout, one per line in .gitc/info/sparse-checkout. a cone
+    // brings in everything below its directory, plus the files (not the subdirectories) of every
+    // directory above it, the top level included. without the file everything is checked out
+    class SparseCheckout {
+    public:
+        enum Match {
+            OUTSIDE,  // nothing below the directory is checked out, it's never opened
+            PARENT,   // a cone is further down: only its files are checked out
+            INSIDE    // the directory is in a cone, everything below it is checked out
+        };
+
+        static SparseCheckout &get() {
+            static SparseCheckout sparse_checkout;
+            return sparse_checkout;
+        }
+
+        bool is_enabled() const {
+            return enabled;
+        }
+
+        const std::vector<std::string> &get_cones() const {
+            return cones;
+        }
+
+        // a directory relative to the root, "" is the root itself
+        Match match_directory(std::string_view directory) const {
+            if (!enabled) return INSIDE;
+            if (directory.empty()) return PARENT;
+
+            Match match = OUTSIDE;
+            for (const std::string &cone: cones) {
+                if (is_below(directory, cone)) return INSIDE;
+                if (is_below(cone, directory)) match = PARENT;
+            }
+
+            return match;
+        }
+
+        bool contains_file(std::string_view path) const {
+            if (!enabled) return true;
+
+            const size_t slash = path.rfind('/');
+            return slash == std::string_view::npos || match_directory(path.substr(0, slash)) != OUTSIDE;
+        }
+
+        // an empty list turns the sparse checkout off
+        void set_cones(std::vector<std::string> directories) {
+            for (std::string &directory: directories) {
+                while (!directory.empty() && directory.back() == '/') directory.pop_back();
+                while (directory.compare(0, 2, "./") == 0) directory.erase(0, 2);
+            }
+            directories.erase(std::remove(directories.begin(), directories.end(), ""), directories.end());
+
+            std::sort(directories.begin(), directories.end());
+            directories.erase(std::unique(directories.begin(), directories.end()), directories.end());
+
+            cones = directories;
+            enabled = !cones.empty();
+
+            const std::string path = file_path();
+            if (!enabled) {
+                Files::delete_file(path);
+                return;
+            }
+
+            std::string content;
+            for (const std::string &cone: cones) {
+                content += cone + "\n";
+            }
+
+            Files::make_parent_dirs(path);
+            Durability::write_file(path, content);
+        }
+
+    private:
+        std::vector<std::string> cones; // sorted, without trailing slashes
+        bool enabled = false;
+
+        SparseCheckout() {
+            std::ifstream file(file_path());
+            std::string line;
+
+            while (std::getline(file, line)) {
+                if (!line.empty() && line[0] != '#') cones.push_back(line);
+            }
+
+            std::sort(cones.begin(), cones.end());
+            enabled = !cones.empty();
+        }
+
+        static std::string file_path() {
+            return Files::join_path(Files::root_path(), ".gitc/info/sparse-checkout");
+        }
+
+        // path is directory or somewhere below it
+        static bool is_below(std::string_view path, std::string_view directory) {
+            return path.compare(0, directory.size(), directory) == 0 &&
+                   (path.size() == directory.size() || path[directory.size()] == '/');
+        }
+    };
+
+} // gitc
+
+#endif //GIT_CLONE_SPARSECHECKOUT_H
@@ -3,124 +3,255 @@
 //
 
 #include <string>
+#include <string_view>
 #include <vector>
-#include <sstream>
+#include <iterator>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory_resource>
 #include "Files.h"
+#include "ObjectDatabase.h"
 
 #ifndef GIT_CLONE_TREE_H
 #define GIT_CLONE_TREE_H
 
 namespace gitc {
 
+    // a tree object is binary and sorted by name:
+    //   u32 count, u32 offset of every entry, then the entries: u8 type, raw id, u16 name length, name
+    // the offsets make entry i reachable without parsing the ones before it, so finding a name is a
+    // binary search and reading a tree is a single read into a buffer, walking it allocates nothing
     class Tree {
     public:
+        enum Entry_type : uint8_t {
+            BLOB, TREE, CHUNKED // a CHUNKED file is a manifest of its chunks, see Blob
+        };
+
+        // path points into the tree's buffer, it is valid as long as the tree is
         struct Tree_entry {
-            std::string path;
-            std::string hash;
-            std::string type;
+            ObjectId hash;
+            std::string_view path;
+            Entry_type type;
         };
 
+        class const_iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Tree_entry;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const Tree_entry *;
+            using reference = const Tree_entry &;
 
-        Tree(std::string _hash) : hash(_hash) {
-            read_from_file();
-        }
+            const_iterator(const Tree *_tree, uint32_t _position) : tree(_tree), position(_position) {
+                if (position < tree->size()) entry = tree->at(position);
+            }
+
+            const Tree_entry &operator*() const {
+                return entry;
+            }
+
+            const Tree_entry *operator->() const {
+                return &entry;
+            }
+
+            const_iterator &operator++() {
+                if (++position < tree->size()) entry = tree->at(position);
+                return *this;
+            }
+
+            bool operator==(const const_iterator &other) const {
+                return position == other.position;
+            }
+
+            bool operator!=(const const_iterator &other) const {
+                return position != other.position;
+            }
+
+        private:
+            const Tree *tree;
+            uint32_t position;
+            Tree_entry entry;
+        };
+
+        // the buffers are allocated from resource, which has to outlive the tree
+        explicit Tree(std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+                : content(resource), added(resource), added_names(resource) {}
 
-        ~Tree() {
-            write_to_file();
+        explicit Tree(const ObjectId &_hash, std::pmr::memory_resource *resource = std::pmr::get_default_resource())
+                : hash(_hash), content(resource), added(resource), added_names(resource) {
+            if (!hash.is_null() && ObjectDatabase::get().read(hash, content)) validate();
         }
 
-        void add_entry(std::string path, std::string hash, std::string type) {
-            Tree_entry *new_entry = new Tree_entry();
-            new_entry->path = path;
-            new_entry->hash = hash;
-            new_entry->type = type;
+        // added entries are sorted and encoded by write_to_file, they can't be read before that
+        void add_entry(std::string_view path, const ObjectId &hash, Entry_type type) {
+            added.push_back({hash, (uint32_t) added_names.size(), (uint16_t) path.size(), type});
+            added_names += path;
+        }
 
-            entries.push_back(new_entry);
+        const ObjectId &get_hash() const {
+            return hash;
         }
 
-        std::vector<Tree_entry *> get_entries() {
-            return entries;
+        uint32_t size() const {
+            return count;
         }
 
-        std::string get_hash_of_directory(const std::string &path) {
-            if (path.find('/') == std::string::npos) {
-                for (Tree_entry *entry: entries) {
-                    if (entry->path == path) {
-                        return entry->hash;
-                    }
-                }
+        Tree_entry at(uint32_t position) const {
+            const uint32_t offset = read_int<uint32_t>(HEADER_SIZE + position * OFFSET_SIZE);
+            const char *entry = content.data() + offset;
+            Tree_entry result;
 
-                return "";
-            }
+            result.type = static_cast<Entry_type>(entry[0]);
+            std::memcpy(result.hash.bytes, entry + 1, ObjectId::SIZE);
+            result.path = std::string_view(entry + ENTRY_HEADER_SIZE, read_int<uint16_t>(offset + 1 + ObjectId::SIZE));
+            return result;
+        }
 
-            std::string top_directory = path.substr(0, path.find('/'));
-            std::string next_path = path.substr(path.find('/') + 1);
+        const_iterator begin() const {
+            return const_iterator(this, 0);
+        }
 
-            for (Tree_entry *entry: entries) {
-                if (entry->path == top_directory) {
-                    Tree *tree = new Tree(entry->hash);
-                    return tree->get_hash_of_directory(next_path);
-                }
-            }
-            return "";
+        const_iterator end() const {
+            return const_iterator(this, count);
         }
 
-        bool search_for_hash(const std::string &hash) {
-            for (Tree_entry *entry: entries) {
-                if (entry->hash == hash) {
+        // binary search for the entry called name
+        bool find(std::string_view name, Tree_entry &entry) const {
+            uint32_t low = 0, high = count;
+
+            while (low < high) {
+                const uint32_t middle = low + (high - low) / 2;
+                const Tree_entry candidate = at(middle);
+
+                if (candidate.path < name) {
+                    low = middle + 1;
+                } else if (name < candidate.path) {
+                    high = middle;
+                } else {
+                    entry = candidate;
                     return true;
-                } else if(entry->type == "tree") {
-                    Tree *tree = new Tree(entry->hash);
-                    if (tree->search_for_hash(hash)) {
-                        delete tree;
-                        return true;
-                    }
-                    delete tree;
                 }
             }
 
             return false;
         }
 
-    private:
-        std::string hash;
-        std::vector<Tree_entry *> entries;
+        // stores the tree in the object database, its hash is only known once all entries are added
+        ObjectId write_to_file() {
+            std::sort(added.begin(), added.end(), [this](const Added_entry &a, const Added_entry &b) {
+                return name_of(a) < name_of(b);
+            });
+
+            content.clear();
+            append_int<uint32_t>((uint32_t) added.size());
 
-        void read_from_file() {
-            std::string file_path = Files::join_path(Files::root_path(), ".gitc/objects/" + hash);
-            std::ifstream file(file_path);
+            uint32_t offset = HEADER_SIZE + (uint32_t) added.size() * OFFSET_SIZE;
+            for (const Added_entry &entry: added) {
+                append_int<uint32_t>(offset);
+                offset += ENTRY_HEADER_SIZE + entry.name_length;
+            }
 
-            if (!file.good()) {
-                return;
+            for (const Added_entry &entry: added) {
+                content += (char) entry.type;
+                content.append(reinterpret_cast<const char *>(entry.hash.bytes), ObjectId::SIZE);
+                append_int<uint16_t>(entry.name_length);
+                content += name_of(entry);
             }
 
-            std::string line;
-            while (std::getline(file, line)) {
-                std::istringstream iss(line);
-                Tree_entry *new_entry = new Tree_entry();
-
-                iss >> new_entry->type >> new_entry->hash;
-                std::getline(iss, new_entry->path);
-                new_entry->path.erase(new_entry->path.begin(),
-                                      std::find_if(new_entry->path.begin(), new_entry->path.end(),
-                                                   [](unsigned char ch) {
-                                                       return !std::isspace(ch);
-                                                   }));
-                entries.push_back(new_entry);
+            added.clear();
+            added_names.clear();
+            validate();
+
+            hash = ObjectDatabase::get().write(content);
+            return hash;
+        }
+
+        // appends every path (files and directories) that differs between the two trees to changed.
+        // both trees are sorted, so they are merged in one pass, and subtrees with the same hash are
+        // identical, so they are never opened
+        static void diff(const ObjectId &old_hash, const ObjectId &new_hash, const std::string &prefix,
+                         std::vector<std::string> &changed) {
+            if (old_hash == new_hash) return;
+
+            Tree old_tree(old_hash), new_tree(new_hash);
+            const_iterator old_entry = old_tree.begin(), new_entry = new_tree.begin();
+
+            while (old_entry != old_tree.end() || new_entry != new_tree.end()) {
+                const bool has_old = old_entry != old_tree.end() &&
+                                     (new_entry == new_tree.end() || old_entry->path <= new_entry->path);
+                const bool has_new = new_entry != new_tree.end() &&
+                                     (old_entry == old_tree.end() || new_entry->path <= old_entry->path);
+
+                const std::string_view name = has_old ? old_entry->path : new_entry->path;
+                const ObjectId old_id = has_old ? old_entry->hash : ObjectId();
+                const ObjectId new_id = has_new ? new_entry->hash : ObjectId();
+
+                if (!has_old || !has_new || old_id != new_id) {
+                    const std::string path = prefix.empty() ? std::string(name) : prefix + "/" += name;
+                    changed.push_back(path);
+
+                    diff(has_old && old_entry->type == TREE ? old_id : ObjectId(),
+                         has_new && new_entry->type == TREE ? new_id : ObjectId(), path, changed);
+                }
+
+                if (has_old) ++old_entry;
+                if (has_new) ++new_entry;
             }
+        }
+
+    private:
+        struct Added_entry {
+            ObjectId hash;
+            uint32_t name_offset;
+            uint16_t name_length;
+            Entry_type type;
+        };
+
+        static const uint32_t HEADER_SIZE = 4;
+        static const uint32_t OFFSET_SIZE = 4;
+        static const uint32_t ENTRY_HEADER_SIZE = 1 + ObjectId::SIZE + 2;
+
+        ObjectId hash;
+        std::pmr::string content;
+        uint32_t count = 0;
+
+        std::pmr::vector<Added_entry> added;
+        std::pmr::string added_names;
 
-            file.close();
+        std::string_view name_of(const Added_entry &entry) const {
+            return std::string_view(added_names).substr(entry.name_offset, entry.name_length);
         }
 
-        void write_to_file() {
-            std::string file_path = Files::join_path(Files::root_path(), ".gitc/objects/" + hash);
-            std::ofstream file(file_path);
+        template<typename T>
+        void append_int(T value) {
+            content.append(reinterpret_cast<const char *>(&value), sizeof value);
+        }
+
+        template<typename T>
+        T read_int(size_t pos) const {
+            T value;
+            std::memcpy(&value, content.data() + pos, sizeof value);
+            return value;
+        }
 
-            for (Tree_entry *entry: entries) {
-                file << entry->type << " " << entry->hash << " " << entry->path << std::endl;
+        // a truncated or otherwise broken tree reads as an empty one, so at() never has to check bounds
+        void validate() {
+            count = 0;
+            if (content.size() < HEADER_SIZE) return;
+
+            const uint32_t claimed = read_int<uint32_t>(0);
+            if (claimed > (content.size() - HEADER_SIZE) / OFFSET_SIZE) return;
+
+            for (uint32_t i = 0; i < claimed; i++) {
+                const uint64_t offset = read_int<uint32_t>(HEADER_SIZE + i * OFFSET_SIZE);
+                if (offset + ENTRY_HEADER_SIZE > content.size() ||
+                    offset + ENTRY_HEADER_SIZE + read_int<uint16_t>(offset + 1 + ObjectId::SIZE) > content.size()) {
+                    return;
+                }
             }
 
-            file.close();
+            count = claimed;
         }
     };
 
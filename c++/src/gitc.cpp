@@ -3,6 +3,9 @@
 //
 #include <iostream>
 #include <string>
+#include <cstdlib>
+#include <cerrno>
+#include <cctype>
 
 #include "gitc.h"
 #include "Files.h"
@@ -13,7 +16,6 @@ int main(int argc, char *argv[]) {
     if (argc == 1) {
         // display help info
         gitc::gitc::help();
-        gitc::Files::delete_file(".gitc/objects/9koyr7mhitbp");
     } else {
         std::string command = argv[1];
 
@@ -33,19 +35,14 @@ int main(int argc, char *argv[]) {
                 return 0;
             }
 
-            for (int i = 2; i < argc; i++) {
-                gitc::gitc().add(argv[i]);
-            }
+            gitc::gitc().add(std::vector<std::string>(argv + 2, argv + argc));
         } else if (command == "rm") {
             if (argc == 2) {
                 std::cout << "Nothing specified, nothing removed." << std::endl;
                 return 0;
             }
 
-            for (int i = 2; i < argc; i++) {
-                gitc::gitc().rm(argv[i]);
-            }
-
+            gitc::gitc().rm(std::vector<std::string>(argv + 2, argv + argc));
         } else if (command == "commit") {
             if (argc != 4 || (std::string) argv[2] != "-m") {
                 std::cout << "fatal: Please provide a commit message using -m flag" << std::endl;
@@ -54,7 +51,11 @@ int main(int argc, char *argv[]) {
 
             gitc::gitc().commit(argv[3]);
         } else if (command == "log") {
-            gitc::gitc().log();
+            if (argc >= 4 && (std::string) argv[2] == "--") {
+                gitc::gitc().log(gitc::Pathspec(std::vector<std::string>(argv + 3, argv + argc)));
+            } else {
+                gitc::gitc().log();
+            }
         } else if (command == "checkout") {
             if (argc != 3) {
                 std::cout << "fatal: Please provide a commit hash" << std::endl;
@@ -69,8 +70,94 @@ int main(int argc, char *argv[]) {
             }
 
             gitc::gitc().revert(argv[2]);
+        } else if (command == "show") {
+            if (argc != 3) {
+                std::cout << "usage: gitc show <commit>[:<path>]" << std::endl;
+                return 0;
+            }
+
+            gitc::gitc().show(argv[2]);
+        } else if (command == "gc") {
+            long grace_period = gitc::GC_GRACE_PERIOD;
+            bool valid = argc == 2;
+
+            if (argc == 3 && (std::string) argv[2] == "--prune=now") {
+                grace_period = 0;
+                valid = true;
+            } else if (argc == 3 && ((std::string) argv[2]).find("--prune=") == 0) {
+                // a number of seconds and nothing else, a typo must not turn into --prune=now
+                const char *seconds = argv[2] + 8;
+                char *end = nullptr;
+                errno = 0;
+                grace_period = std::strtol(seconds, &end, 10);
+                valid = isdigit((unsigned char) seconds[0]) && *end == '\0' && errno == 0;
+            }
+
+            if (!valid) {
+                std::cout << "usage: gitc gc [--prune=<seconds>|now]" << std::endl;
+                return 0;
+            }
+
+            gitc::gitc().gc(grace_period);
+        } else if (command == "repack") {
+            if (argc > 3 || (argc == 3 && (std::string) argv[2] != "--write-bitmap")) {
+                std::cout << "usage: gitc repack [--write-bitmap]" << std::endl;
+                return 0;
+            }
+
+            gitc::gitc().repack(argc == 3);
+        } else if (command == "count-objects") {
+            gitc::gitc repository;
+            repository.count_objects(argc == 3 ? argv[2] : repository.get_head_commit_hash().to_hex(), false);
+        } else if (command == "rev-list") {
+            if (argc < 3 || argc > 4 || (std::string) argv[2] != "--objects") {
+                std::cout << "usage: gitc rev-list --objects [<commit>]" << std::endl;
+                return 0;
+            }
+
+            gitc::gitc repository;
+            repository.count_objects(argc == 4 ? argv[3] : repository.get_head_commit_hash().to_hex(), true);
+        } else if (command == "sparse-checkout") {
+            const std::string subcommand = argc > 2 ? argv[2] : "";
+
+            if (subcommand == "set" && argc > 3) {
+                gitc::gitc().sparse_checkout_set(std::vector<std::string>(argv + 3, argv + argc));
+            } else if (subcommand == "disable" && argc == 3) {
+                gitc::gitc().sparse_checkout_set({});
+            } else if (subcommand == "list" && argc == 3) {
+                gitc::gitc().sparse_checkout_list();
+            } else {
+                std::cout << "usage: gitc sparse-checkout (set <directory>... | list | disable)" << std::endl;
+            }
+        } else if (command == "branch" || command == "tag") {
+            const bool is_branch = command == "branch";
+            gitc::gitc repository;
+
+            if (argc == 2) {
+                is_branch ? repository.branch_list() : repository.tag_list();
+            } else if (argc == 4 && (std::string) argv[2] == "-d") {
+                is_branch ? repository.branch_delete(argv[3]) : repository.tag_delete(argv[3]);
+            } else if ((argc == 3 || argc == 4) && argv[2][0] != '-') {
+                const std::string start = argc == 4 ? argv[3] : "HEAD";
+                is_branch ? repository.branch_create(argv[2], start) : repository.tag_create(argv[2], start);
+            } else {
+                std::cout << "usage: gitc " << command << " [<name> [<commit>] | -d <name>]" << std::endl;
+            }
+        } else if (command == "switch") {
+            if (argc == 3 && argv[2][0] != '-') {
+                gitc::gitc().switch_branch(argv[2], false);
+            } else if (argc == 4 && (std::string) argv[2] == "-c") {
+                gitc::gitc().switch_branch(argv[3], true);
+            } else {
+                std::cout << "usage: gitc switch [-c] <branch>" << std::endl;
+            }
+        } else if (command == "pack-refs") {
+            gitc::gitc().pack_refs();
+        } else if (command == "reflog") {
+            gitc::gitc().reflog(argc > 2 ? argv[2] : "");
         } else if (command == "status") {
-            gitc::gitc().status();
+            const int first = argc > 2 && (std::string) argv[2] == "--" ? 3 : 2;
+            gitc::gitc().status(gitc::Pathspec(std::vector<std::string>(argv + first, argv + argc)));
         } else {
             std::cout << "gitc: '" << command << "' is not a gitc command. See 'gitc --help'." << std::endl;
         }
@@ -5,6 +5,17 @@
 #include "Index.h"
 #include "Head.h"
 #include "Commit.h"
+#include "ObjectDatabase.h"
+#include "CommitGraph.h"
+#include "GarbageCollector.h"
+#include "PathResolver.h"
+#include "Blob.h"
+#include "AddPipeline.h"
+#include "Sha256Lanes.h"
+#include "Durability.h"
+#include "SparseCheckout.h"
+#include "Pathspec.h"
+#include "Abbreviation.h"
 
 #ifndef GIT_CLONE_GITC_H
 #define GIT_CLONE_GITC_H
@@ -16,9 +27,6 @@ namespace gitc {
 #ifndef __linux__
             srand(time(NULL));
 #endif
-            index = new Index();
-            head = new Head();
-
             if (!Files::in_repo()) {
                 std::cout << "fatal: not a gitc repository (or any of the parent directories): .gitc" << std::endl;
                 std::exit(1);
@@ -28,6 +36,8 @@ namespace gitc {
         ~gitc() {
             delete index;
             delete head;
+            ObjectDatabase::get().flush();
+            Durability::sync_objects();
         }
 
         static void init() {
@@ -43,131 +53,471 @@ namespace gitc {
             std::cout << "Initialized empty gitc repository in " << Files::get_cwd() << "/.gitc" << std::endl;
         }
 
-        void add(const std::string &path) {
-            std::vector<std::string> added_files = Files::ls_recursive(path);
+        void add(const std::vector<std::string> &specs) {
+            const Pathspec pathspec(specs);
+            std::vector<AddPipeline::Stored_file> added_files;
+            AddPipeline::store(pathspec, added_files);
 
-            if (added_files.empty()) {
-                std::cout << path << " did not match any files" << std::endl;
-                return;
+            for (const std::string &spec: pathspec.unmatched()) {
+                std::cout << spec << " did not match any files" << std::endl;
             }
 
-            for (std::string &file: added_files) {
-                // update the file in the index
-                index->update(file, ADD);
+            // every object is written by now, the index is updated in one go
+            for (AddPipeline::Stored_file &file: added_files) {
+                get_index().stage(file.path, file.hash, file.type);
             }
         }
 
-        void rm(const std::string &path) {
-            std::vector<std::string> removed_files = Files::ls_recursive(path);
+        void rm(const std::vector<std::string> &specs) {
+            const Pathspec pathspec(specs);
+            std::vector<std::string> removed_files;
 
-            if (removed_files.empty()) {
-                std::cout << path << " did not match any files" << std::endl;
-                return;
+            get_index().for_each_match(pathspec, [this, &removed_files](size_t position) {
+                if (get_index().get_stage(position) != UNTRACKED) removed_files.push_back(get_index().get_path(position));
+            });
+
+            for (const std::string &spec: pathspec.unmatched()) {
+                std::cout << spec << " did not match any files" << std::endl;
             }
 
             for (std::string &file: removed_files) {
                 // update the file in the index
-                index->update(file, REMOVE);
+                get_index().update(file, REMOVE);
             }
         }
 
-        void status() {
-            std::cout << "On branch master" << std::endl;
+        // only the paths the pathspec matches are listed, and only those are compared to the index
+        void status(const Pathspec &pathspec = Pathspec()) {
+            std::cout << "On branch " << get_head().get_branch() << std::endl;
+
+            std::vector<size_t> matched;
+            get_index().for_each_match(pathspec, [&matched](size_t position) { matched.push_back(position); });
 
-            if (index->is_staged()) {
+            bool has_untracked = false;
+            if (get_index().is_staged()) {
                 std::cout << "Changes to be commited:" << std::endl;
                 std::cout << "   (use the rm command to unstage the files)" << std::endl;
 
-                for (auto entry: index->get_entries()) {
-                    if (entry->stage_number == STAGED) {
-                        std::cout << "  \t" << entry->path << std::endl;
+                for (size_t i: matched) {
+                    if (get_index().get_stage(i) == STAGED) {
+                        std::cout << "  \t" << get_index().get_path(i) << std::endl;
                     }
                 }
             }
 
-            if (index->has_untracked_files()) {
+            std::vector<size_t> tracked;
+            for (size_t i: matched) {
+                has_untracked |= get_index().get_stage(i) == UNTRACKED;
+                // files outside a sparse checkout's cones aren't on disk
+                if (get_index().get_stage(i) != UNTRACKED && get_index().get_type(i) != Tree::TREE &&
+                    SparseCheckout::get().contains_file(get_index().get_path(i)))
+                    tracked.push_back(i);
+            }
+            std::vector<std::string> modified = modified_files(tracked);
+
+            if (!modified.empty() || has_untracked) {
                 std::cout << "Changes not staged for commit:" << std::endl;
                 std::cout << "   (use \"add/rm <file>...\" to update what will be committed)" << std::endl;
 
-                for (auto entry: index->get_entries()) {
-                    if (entry->stage_number == UNTRACKED) {
-                        std::cout << "  \t" << entry->path << std::endl;
+                for (std::string &path: modified) {
+                    std::cout << "  \tmodified: " << path << std::endl;
+                }
+
+                for (size_t i: matched) {
+                    if (get_index().get_stage(i) == UNTRACKED) {
+                        std::cout << "  \t" << get_index().get_path(i) << std::endl;
                     }
                 }
             }
         }
 
         void commit(const std::string &message) {
-            if (!index->is_staged()) {
+            if (!get_index().is_staged()) {
                 std::cout << "Please add files first to commit" << std::endl;
                 return;
             }
             // make a commit object, object tree (which is the snapshot of index), and update the head
-            Commit *new_commit = Commit::create_commit_from_index(*index, head->get_last_commit_hash(), message);
-            head->update_last_commit_hash(new_commit->get_commit_hash());
+            Commit *new_commit = Commit::create_commit_from_index(get_index(), get_head().get_last_commit_hash(),
+                                                                  get_head().get_branch(), message);
+            get_head().update_last_commit_hash(new_commit->get_commit_hash(), "commit: " + message);
+
+            CommitGraph graph;
+            uint32_t parent_position;
+            if (!new_commit->get_parent_commit_hash().is_null())
+                graph.lookup_or_import(new_commit->get_parent_commit_hash(), parent_position);
+            graph.append(*new_commit);
+
             delete new_commit;
         }
 
-        void checkout(const std::string &commit_hash) {
-            if (!Head::commit_exists(commit_hash)) {
-                std::cout << "fatal: commit " << commit_hash << " does not exist" << std::endl;
+        void checkout(const std::string &name) {
+            ObjectId commit_hash;
+            if (!resolve(name, commit_hash)) {
                 return;
             }
 
-            if (index->has_untracked_files()) {
-                std::cout << "fatal: Your local changes to the following files would be overwritten by checkout:"
-                          << std::endl;
+            if (has_local_changes("checkout")) {
+                return;
+            }
 
-                for (auto &entry : index->get_entries()) {
-                    if (entry->stage_number == UNTRACKED)
-                        std::cout << "   " << entry->path << std::endl;
-                }
+            Commit commit(commit_hash);
+            commit.update_working_directory(get_index());
+        }
 
-                std::cout << "Aborting" << std::endl;
+        void revert(const std::string &name) {
+            ObjectId commit_hash;
+            if (!resolve(name, commit_hash)) {
                 return;
             }
 
-            Commit *commit = new Commit(commit_hash);
-            commit->update_working_directory();
-            delete commit;
+            CommitGraph graph;
+            uint32_t target, current;
+
+            // commits HEAD was moved away from can be reverted back to, that's how a revert is undone
+            if (!graph.lookup_or_import(commit_hash, target) ||
+                !graph.lookup_or_import(get_head().get_last_commit_hash(), current) ||
+                (!graph.is_ancestor(target, current) && !in_reflog(commit_hash))) {
+                std::cout << "fatal: commit " << commit_hash << " is not an ancestor of HEAD" << std::endl;
+                return;
+            }
+
+            if (has_local_changes("revert")) {
+                return;
+            }
+
+            Commit commit(commit_hash);
+            commit.update_working_directory(get_index());
+
+            // the newer commits stay in the object database (and the reflog) until gc finds them unreachable
+            get_head().update_last_commit_hash(commit_hash, "revert: moving to " + commit_hash.to_hex());
+            gc_in_background();
         }
 
-        void revert(const std::string &commit_hash) {
-            if (!Head::commit_exists(commit_hash)) {
-                std::cout << "fatal: commit " << commit_hash << " does not exist" << std::endl;
+        // lists the branches, the current one starred
+        void branch_list() {
+            const std::string current = get_head().get_head_ref();
+            for (const Refs::Ref &ref: Refs::get().list(std::string(Refs::BRANCH_PREFIX))) {
+                std::cout << (ref.name == current ? "* " : "  ") << ref.name.substr(Refs::BRANCH_PREFIX.size()) << "\n";
+            }
+            std::cout.flush();
+        }
+
+        // starts a branch at the commit start stands for
+        void branch_create(const std::string &name, const std::string &start) {
+            create_ref("branch", std::string(Refs::BRANCH_PREFIX), name, start);
+        }
+
+        void branch_delete(const std::string &name) {
+            if (std::string(Refs::BRANCH_PREFIX) + name == get_head().get_head_ref()) {
+                std::cout << "error: cannot delete branch '" << name << "' checked out" << std::endl;
                 return;
             }
 
-            Commit *commit = new Commit(commit_hash);
-            commit->update_working_directory();
-            delete commit;
+            delete_ref("branch", std::string(Refs::BRANCH_PREFIX), name);
+        }
 
-            // delete the current commit and update the head
-            while (head->get_last_commit_hash() != commit_hash) {
-                std::string last_commit_hash = head->get_last_commit_hash();
-                commit = new Commit(last_commit_hash);
-                commit->delete_commit();
-                head->update_last_commit_hash(commit->get_parent_commit_hash());
-                delete commit;
-                Files::delete_file(Files::join_path(Files::relative_root_path(), ".gitc/objects/" + last_commit_hash));
+        void tag_list() {
+            for (const Refs::Ref &ref: Refs::get().list(std::string(Refs::TAG_PREFIX))) {
+                std::cout << ref.name.substr(Refs::TAG_PREFIX.size()) << "\n";
             }
+            std::cout.flush();
+        }
+
+        void tag_create(const std::string &name, const std::string &start) {
+            create_ref("tag", std::string(Refs::TAG_PREFIX), name, start);
+        }
+
+        void tag_delete(const std::string &name) {
+            delete_ref("tag", std::string(Refs::TAG_PREFIX), name);
+        }
+
+        // checks the branch out and makes it the current one. with create the branch is started at HEAD
+        // first, which leaves the working directory as it is
+        void switch_branch(const std::string &name, bool create) {
+            const std::string ref = std::string(Refs::BRANCH_PREFIX) + name;
+            if (ref == get_head().get_head_ref()) {
+                std::cout << "Already on '" << name << "'" << std::endl;
+                return;
+            }
+
+            ObjectId target = get_head().get_last_commit_hash();
+            if (create) {
+                // a branch without commits is only a name in HEAD until the first commit
+                if (!target.is_null() && !create_ref("branch", std::string(Refs::BRANCH_PREFIX), name, "HEAD")) return;
+                if (target.is_null() && !Refs::is_valid_name(name)) {
+                    std::cout << "fatal: '" << name << "' is not a valid branch name" << std::endl;
+                    return;
+                }
+            } else if (!Refs::get().read(ref, target)) {
+                std::cout << "fatal: invalid reference: " << name << std::endl;
+                return;
+            }
+
+            if (target != get_head().get_last_commit_hash()) {
+                if (has_local_changes("switch")) {
+                    return;
+                }
+
+                Commit commit(target);
+                commit.update_working_directory(get_index());
+            }
+
+            get_head().update_head_ref(ref);
+            std::cout << (create ? "Switched to a new branch '" : "Switched to branch '") << name << "'" << std::endl;
+        }
+
+        // moves the loose branches and tags into packed-refs
+        void pack_refs() {
+            std::cout << "Packed " << Refs::get().pack() << " refs" << std::endl;
         }
 
-        void log() {
-            if (head->get_last_commit_hash().empty()) {
+        // restricts the working tree to the cones below directories, none checks out everything again.
+        // files leaving the cones are deleted and files entering them written, from what the index tracks.
+        // the directories that left stay file by file in the index until the next checkout collapses them
+        void sparse_checkout_set(const std::vector<std::string> &directories) {
+            Index &index = get_index();
+            SparseCheckout &sparse = SparseCheckout::get();
+            const std::vector<std::string> old_cones = sparse.get_cones();
+            std::vector<size_t> positions;
+            std::vector<bool> was_checked_out;
+
+            for (size_t i = 0; i < index.size(); i++) {
+                if (index.get_stage(i) == UNTRACKED || index.get_type(i) == Tree::TREE) continue;
+                positions.push_back(i);
+                was_checked_out.push_back(sparse.contains_file(index.get_path(i)));
+            }
+
+            sparse.set_cones(directories);
+
+            std::vector<size_t> leaving;
+            for (size_t j = 0; j < positions.size(); j++) {
+                if (was_checked_out[j] && !sparse.contains_file(index.get_path(positions[j]))) {
+                    leaving.push_back(positions[j]);
+                }
+            }
+
+            for (const std::string &path: modified_files(leaving)) {
+                std::cout << "fatal: " << path << " has changes that would be lost, add or restore it first" << std::endl;
+                sparse.set_cones(old_cones);
+                return;
+            }
+
+            const std::string root = Files::root_path();
+            for (size_t j = 0; j < positions.size(); j++) {
+                const size_t i = positions[j];
+                const std::string path = index.get_path(i);
+                const bool checked_out = sparse.contains_file(path);
+
+                if (was_checked_out[j] && !checked_out) {
+                    Files::delete_file(Files::join_path(root, path));
+                    Files::remove_empty_parent_dirs(root, path);
+                } else if (!was_checked_out[j] && checked_out) {
+                    Files::make_parent_dirs(Files::join_path(root, path));
+                    Blob::write_to_file(index.get_hash(i), index.get_type(i), Files::join_path(root, path));
+                }
+            }
+
+            // directories collapsed to a tree entry that are now in a cone
+            for (size_t i: index.expand_directories()) {
+                const std::string path = Files::join_path(root, index.get_path(i));
+                if (!SparseCheckout::get().contains_file(index.get_path(i))) continue;
+
+                Files::make_parent_dirs(path);
+                Blob::write_to_file(index.get_hash(i), index.get_type(i), path);
+            }
+        }
+
+        void sparse_checkout_list() {
+            for (const std::string &cone: SparseCheckout::get().get_cones()) {
+                std::cout << cone << "\n";
+            }
+            std::cout.flush();
+        }
+
+        // where a branch has been, the current one by default, newest first
+        void reflog(const std::string &branch = "") {
+            const std::string ref = branch.empty() ? get_head().get_head_ref() : std::string(Refs::BRANCH_PREFIX) + branch;
+            const std::string name = branch.empty() ? "HEAD" : branch;
+            size_t position = 0;
+
+            Reflog::scan_reverse(ref, [&name, &position](const Reflog_entry &entry) {
+                std::cout << (entry.new_hash.is_null() ? "-" : entry.new_hash.to_hex()) << " " << name << "@{"
+                          << position++ << "}: " << entry.message << "\n";
+                return true;
+            });
+            std::cout.flush();
+        }
+
+        void log(const Pathspec &pathspec = Pathspec()) {
+            if (get_head().get_last_commit_hash().is_null()) {
                 std::cout << "No commits to display" << std::endl;
                 return;
             }
 
-            Commit *current_commit = new Commit(head->get_last_commit_hash());
-            current_commit->print_commit(true);
+            CommitGraph graph;
+            ObjectArena arena;
+            uint32_t position;
+            std::string path;
+            // a single path can be answered by the commit graph's filters, anything else by diffing trees
+            const bool is_single_path = pathspec.is_single_path(path);
+
+            if (!graph.lookup_or_import(get_head().get_last_commit_hash(), position)) {
+                std::cout << "fatal: bad HEAD commit " << get_head().get_last_commit_hash() << std::endl;
+                return;
+            }
+
+            const uint32_t head_position = position;
+            std::vector<uint32_t> shown;
+            std::vector<ObjectId> hashes;
 
-            while (!current_commit->get_parent_commit_hash().empty()) {
-                std::string next_commit_hash = current_commit->get_parent_commit_hash();
-                delete current_commit;
-                current_commit = new Commit(next_commit_hash);
-                current_commit->print_commit(false);
+            while (position != CommitGraph::NO_PARENT) {
+                const Commit_graph_entry &entry = graph.at(position);
+                const uint32_t current = position;
+                position = entry.parent;
+
+                arena.release();
+                if (is_single_path && !path.empty() && !touches_path(graph, entry, path, arena.get())) {
+                    continue;
+                }
+                if (!is_single_path && !pathspec.is_empty() && !touches_pathspec(graph, entry, pathspec)) {
+                    continue;
+                }
+
+                shown.push_back(current);
+                hashes.push_back(CommitGraph::get_commit_hash(entry));
+            }
+
+            // all the abbreviations at once, the objects are looked up per fanout instead of per commit
+            const std::vector<size_t> lengths = Abbreviation::shortest_unique(hashes, ObjectDatabase::get());
+
+            for (size_t i = 0; i < shown.size(); i++) {
+                const Commit_graph_entry &entry = graph.at(shown[i]);
+                Commit::print_commit(hashes[i], entry.timestamp, graph.get_message(entry),
+                                     shown[i] == head_position ? get_head().get_branch() : "", lengths[i]);
             }
+
+            std::cout.flush();
+        }
+
+        // show <commit> prints the commit and the paths it changed, show <commit>:<path> prints the file
+        // (or lists the directory) at path in that commit
+        void show(const std::string &object) {
+            const size_t colon = object.find(':');
+            const std::string name = object.substr(0, colon);
+            ObjectId commit_hash;
+
+            if (!resolve(name, commit_hash)) {
+                return;
+            }
+
+            Commit commit(commit_hash);
+
+            if (colon == std::string::npos) {
+                std::vector<std::string> changed;
+                const ObjectId parent_hash = commit.get_parent_commit_hash();
+
+                Tree::diff(parent_hash.is_null() ? ObjectId() : Commit(parent_hash).get_tree_hash(),
+                           commit.get_tree_hash(), "", changed);
+
+                commit.print_commit(commit_hash == get_head().get_last_commit_hash() ? get_head().get_branch() : "");
+                for (const std::string &path: changed) {
+                    std::cout << "  " << path << "\n";
+                }
+                std::cout.flush();
+                return;
+            }
+
+            std::string path = object.substr(colon + 1);
+            if (path.compare(0, 2, "./") == 0) path.erase(0, 2);
+
+            ObjectArena arena;
+            PathResolver resolver(commit.get_tree_hash(), arena.get());
+            Tree::Tree_entry entry;
+
+            if (!resolver.resolve(path, entry)) {
+                std::cout << "fatal: path '" << path << "' does not exist in '" << name << "'" << std::endl;
+                return;
+            }
+
+            if (entry.type == Tree::TREE) {
+                for (const Tree::Tree_entry &child: Tree(entry.hash, arena.get())) {
+                    std::cout << child.path << (child.type == Tree::TREE ? "/" : "") << "\n";
+                }
+            } else {
+                Blob::write_to(entry.hash, entry.type, std::cout);
+            }
+
+            std::cout.flush();
+        }
+
+        void gc(long grace_period) {
+            Refs::get().pack();
+            Refs::get().expire_reflogs(time(nullptr) - REFLOG_EXPIRE);
+
+            GarbageCollector collector;
+            mark_roots(collector);
+
+            std::cout << "Removed " << collector.sweep(grace_period) << " unreachable objects" << std::endl;
+        }
+
+        void repack(bool write_bitmaps) {
+            RepositoryObjectDatabase *repository = dynamic_cast<RepositoryObjectDatabase *>(&ObjectDatabase::get());
+            if (repository == nullptr) return;
+
+            // only reachable objects are packed, the rest stay loose for gc
+            std::vector<ObjectId> reachable;
+            {
+                GarbageCollector collector;
+                mark_roots(collector);
+                reachable = collector.get_marked();
+            }
+
+            const std::vector<std::string> old_packs = repository->get_packed().get_packs();
+            const std::string pack = PackObjectDatabase::write_pack(repository->get_packed().get_pack_dir(),
+                                                                    reachable, *repository);
+
+            for (const std::string &old_pack: old_packs) {
+                Files::delete_file(old_pack + ".pack");
+                Files::delete_file(old_pack + ".idx");
+                Files::delete_file(old_pack + ".bitmap");
+            }
+
+            for (const ObjectId &hash: reachable) {
+                repository->get_loose().remove(hash);
+            }
+
+            ObjectDatabase::set(nullptr);
+
+            if (write_bitmaps && !get_head().get_last_commit_hash().is_null()) {
+                ReachabilityBitmaps::write(pack, {get_head().get_last_commit_hash()});
+            }
+
+            std::cout << "Packed " << reachable.size() << " objects" << std::endl;
+        }
+
+        void count_objects(const std::string &name, bool list) {
+            ObjectId commit_hash;
+            if (!resolve(name, commit_hash)) {
+                return;
+            }
+
+            ReachabilityBitmaps bitmaps;
+
+            if (!list) {
+                std::cout << bitmaps.count(commit_hash) << std::endl;
+                return;
+            }
+
+            std::vector<ObjectId> objects;
+            bitmaps.reachable(commit_hash, objects);
+            for (const ObjectId &object: objects) {
+                std::cout << object << "\n";
+            }
+            std::cout.flush();
+        }
+
+        ObjectId get_head_commit_hash() {
+            return get_head().get_last_commit_hash();
         }
 
         static void help() {
@@ -182,12 +532,24 @@ namespace gitc {
                       << "   add               Add file contents to the index\n"
                       << "   rm                Remove files from the working tree and from the index\n\n"
                       << "examine the history and state\n"
-                      << "   log               Show commit logs\n"
-                      << "   status            Show the working tree status\n"
-                      << "   checkout          Checkout a commit\n\n"
+                      << "   log [-- <path>]   Show commit logs\n"
+                      << "   status [<path>]   Show the working tree status\n"
+                      << "   show              Show a commit, or a file in it (<commit>:<path>)\n"
+                      << "   checkout          Checkout a commit\n"
+                      << "   switch            Switch to a branch (-c <branch> starts it at HEAD)\n"
+                      << "   sparse-checkout   Only check out some directories (set <dir>... | list | disable)\n\n"
                       << "grow, mark and tweak your common history\n"
                       << "   commit            Record changes to the repository\n"
-                      << "   revert            Revert a commit\n\n\n"
+                      << "   branch            List, create (<name> [<commit>]) or delete (-d <name>) branches\n"
+                      << "   tag               List, create (<name> [<commit>]) or delete (-d <name>) tags\n"
+                      << "   revert            Revert a commit\n"
+                      << "   reflog [<branch>] Show where HEAD or a branch has been\n\n"
+                      << "maintain the repository\n"
+                      << "   gc                Delete unreachable objects (--prune=<seconds>|now)\n"
+                      << "   repack            Pack reachable objects (--write-bitmap)\n"
+                      << "   pack-refs         Move the branches and tags into .gitc/packed-refs\n"
+                      << "   count-objects     Count the objects reachable from a commit\n"
+                      << "   rev-list          List the objects reachable from a commit (--objects)\n\n\n"
                       << "'gitc --help' and 'gitc -h' list available subcommands"
                       << std::endl << std::endl;
 
@@ -196,9 +558,213 @@ namespace gitc {
 
     private:
         Files files;
-        Head *head;
-        Index *index;
+        // loaded on first use, so a command only reads (and writes back) what it needs
+        Head *head = nullptr;
+        Index *index = nullptr;
+
+        Head &get_head() {
+            if (head == nullptr) head = new Head();
+            return *head;
+        }
+
+        // reading the index walks the whole working tree
+        Index &get_index() {
+            if (index == nullptr) index = new Index();
+            return *index;
+        }
+
+        // the paths of the index entries at positions whose contents differ from what the index has for
+        // them. they are read and hashed a batch at a time, so small files are hashed side by side
+        std::vector<std::string> modified_files(const std::vector<size_t> &positions) {
+            const size_t BATCH_SIZE = 2 * Sha256Lanes::LANES;
+            std::vector<std::string> modified;
+
+            for (size_t start = 0; start < positions.size(); start += BATCH_SIZE) {
+                std::string paths[BATCH_SIZE];
+                ObjectId hashes[BATCH_SIZE];
+                Tree::Entry_type types[BATCH_SIZE];
+                const size_t count = std::min(BATCH_SIZE, positions.size() - start);
+
+                for (size_t j = 0; j < count; j++) {
+                    paths[j] = get_index().get_path(positions[start + j]);
+                }
+                Blob::hash_many(paths, count, hashes, types);
+
+                for (size_t j = 0; j < count; j++) {
+                    if (hashes[j] != get_index().get_hash(positions[start + j])) modified.push_back(paths[j]);
+                }
+            }
+
+            return modified;
+        }
+
+        void mark_roots(GarbageCollector &collector) {
+            collector.mark_commit(get_head().get_last_commit_hash());
+            collector.mark_refs();
+            collector.mark_reflogs(time(nullptr) - REFLOG_EXPIRE);
+            collector.mark_index(get_index());
+        }
+
+        void gc_in_background() {
+#ifdef __linux__
+            // the child gets a copy of head and index, so it sees the repository as this command leaves it
+            if (fork() == 0) {
+                setsid();
+
+                GarbageCollector collector;
+                mark_roots(collector);
+                collector.sweep(GC_GRACE_PERIOD);
 
+                _exit(0);
+            }
+#endif
+        }
+
+        bool has_local_changes(const std::string &command) {
+            if (!get_index().has_untracked_files()) {
+                return false;
+            }
+
+            std::cout << "fatal: Your local changes to the following files would be overwritten by " << command
+                      << ":" << std::endl;
+
+            for (size_t i = 0; i < get_index().size(); i++) {
+                if (get_index().get_stage(i) == UNTRACKED)
+                    std::cout << "   " << get_index().get_path(i) << std::endl;
+            }
+
+            std::cout << "Aborting" << std::endl;
+            return true;
+        }
+
+        // the commit a name given on the command line stands for: HEAD, a tag or branch, a full id, or a
+        // prefix of at least Abbreviation::MIN_RESOLVE_LENGTH digits that only one object starts with
+        bool resolve(const std::string &name, ObjectId &commit_hash) {
+            std::string ref;
+            if (name == "HEAD") {
+                commit_hash = get_head().get_last_commit_hash();
+            } else if (!Refs::get().resolve(name, ref, commit_hash)) {
+                commit_hash = ObjectId::from_hex(name);
+            }
+
+            if (commit_hash.is_null() && name.size() >= Abbreviation::MIN_RESOLVE_LENGTH) {
+                const std::vector<ObjectId> candidates = Abbreviation::find(name, ObjectDatabase::get());
+
+                if (candidates.size() > 1) {
+                    std::cout << "error: short object ID " << name << " is ambiguous" << std::endl;
+                    std::cout << "hint: The candidates are:" << std::endl;
+                    for (const ObjectId &candidate: candidates) {
+                        std::cout << "hint:   " << candidate << std::endl;
+                    }
+                    std::cout << "fatal: ambiguous argument '" << name << "'" << std::endl;
+                    return false;
+                }
+
+                if (candidates.size() == 1) commit_hash = candidates[0];
+            }
+
+            if (!Head::commit_exists(commit_hash)) {
+                std::cout << "fatal: commit " << name << " does not exist" << std::endl;
+                return false;
+            }
+
+            return true;
+        }
+
+        bool create_ref(const std::string &kind, const std::string &prefix, const std::string &name,
+                        const std::string &start) {
+            ObjectId hash, existing;
+            if (!Refs::is_valid_name(name)) {
+                std::cout << "fatal: '" << name << "' is not a valid " << kind << " name" << std::endl;
+                return false;
+            }
+            if (Refs::get().read(prefix + name, existing)) {
+                std::cout << "fatal: a " << kind << " named '" << name << "' already exists" << std::endl;
+                return false;
+            }
+            return resolve(start, hash) && Refs::get().update(prefix + name, hash, ObjectId(), kind + ": created from " + start);
+        }
+
+        void delete_ref(const std::string &kind, const std::string &prefix, const std::string &name) {
+            ObjectId hash;
+            if (!Refs::get().read(prefix + name, hash)) {
+                std::cout << "error: " << kind << " '" << name << "' not found" << std::endl;
+                return;
+            }
+
+            if (Refs::get().remove(prefix + name)) {
+                std::cout << "Deleted " << kind << " " << name << " (was " << hash.to_hex().substr(0, Abbreviation::MIN_LENGTH)
+                          << ")" << std::endl;
+            }
+        }
+
+        bool in_reflog(const ObjectId &commit_hash) {
+            bool found = false;
+            Reflog::scan_reverse(get_head().get_head_ref(), [&commit_hash, &found](const Reflog_entry &entry) {
+                found = entry.old_hash == commit_hash;
+                return !found;
+            });
+            return found;
+        }
+
+        static bool touches_path(CommitGraph &graph, const Commit_graph_entry &entry, const std::string &path,
+                                 std::pmr::memory_resource *resource) {
+            if (!graph.may_have_changed(entry, path)) {
+                return false;
+            }
+
+            // the filter can give false positives, so compare what path points to in both trees
+            ObjectId parent_hash;
+            if (entry.parent != CommitGraph::NO_PARENT) {
+                parent_hash = PathResolver(CommitGraph::get_tree_hash(graph.at(entry.parent)), resource).resolve(path);
+            }
+
+            return PathResolver(CommitGraph::get_tree_hash(entry), resource).resolve(path) != parent_hash;
+        }
+
+        static bool touches_pathspec(CommitGraph &graph, const Commit_graph_entry &entry, const Pathspec &pathspec) {
+            const ObjectId parent_hash = entry.parent == CommitGraph::NO_PARENT ? ObjectId()
+                                                                                : CommitGraph::get_tree_hash(graph.at(entry.parent));
+            return changes_match(parent_hash, CommitGraph::get_tree_hash(entry), "", pathspec);
+        }
+
+        // whether a file the pathspec matches differs between the trees. like Tree::diff, but only the
+        // subtrees the pathspec can match are read, and it stops at the first file
+        static bool changes_match(const ObjectId &old_hash, const ObjectId &new_hash, const std::string &prefix,
+                                  const Pathspec &pathspec) {
+            if (old_hash == new_hash || (!prefix.empty() && !pathspec.may_match_below(prefix))) return false;
+
+            Tree old_tree(old_hash), new_tree(new_hash);
+            Tree::const_iterator old_entry = old_tree.begin(), new_entry = new_tree.begin();
+
+            while (old_entry != old_tree.end() || new_entry != new_tree.end()) {
+                const bool has_old = old_entry != old_tree.end() &&
+                                     (new_entry == new_tree.end() || old_entry->path <= new_entry->path);
+                const bool has_new = new_entry != new_tree.end() &&
+                                     (old_entry == old_tree.end() || new_entry->path <= old_entry->path);
+
+                const std::string_view name = has_old ? old_entry->path : new_entry->path;
+                const bool old_is_tree = has_old && old_entry->type == Tree::TREE;
+                const bool new_is_tree = has_new && new_entry->type == Tree::TREE;
+
+                if (!has_old || !has_new || old_entry->hash != new_entry->hash) {
+                    const std::string path = prefix.empty() ? std::string(name) : prefix + "/" += name;
+
+                    // a file on either side that matches, or a subtree with one
+                    if (((has_old && !old_is_tree) || (has_new && !new_is_tree)) && pathspec.matches(path)) return true;
+                    if ((old_is_tree || new_is_tree) &&
+                        changes_match(old_is_tree ? old_entry->hash : ObjectId(),
+                                      new_is_tree ? new_entry->hash : ObjectId(), path, pathspec)) {
+                        return true;
+                    }
+                }
+
+                if (has_old) ++old_entry;
+                if (has_new) ++new_entry;
+            }
+
+            return false;
+        }
     };
 
 } // gitc
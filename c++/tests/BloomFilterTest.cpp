@@ -0,0 +1,47 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include "Test.h"
+#include "../src/BloomFilter.h"
+
+using namespace gitc;
+
+TEST(bloom_filter_has_no_false_negatives) {
+    BloomFilter filter(1000);
+    for (int i = 0; i < 1000; i++) filter.add("dir/file" + std::to_string(i));
+
+    bool all_found = true;
+    for (int i = 0; i < 1000; i++) all_found &= filter.maybe_contains("dir/file" + std::to_string(i));
+    CHECK(all_found);
+}
+
+TEST(bloom_filter_false_positive_rate) {
+    BloomFilter filter(1000);
+    for (int i = 0; i < 1000; i++) filter.add("dir/file" + std::to_string(i));
+
+    // 10 bits and 7 hashes per entry is about 1%
+    int false_positives = 0;
+    for (int i = 0; i < 10000; i++) false_positives += filter.maybe_contains("other/file" + std::to_string(i));
+    CHECK(false_positives < 300);
+}
+
+TEST(bloom_filter_round_trips_through_its_bits) {
+    BloomFilter filter(3);
+    filter.add("a");
+    filter.add("a/b");
+
+    const BloomFilter read(filter.get_bits());
+    CHECK(read.maybe_contains("a"));
+    CHECK(read.maybe_contains("a/b"));
+    CHECK(read.get_bits() == filter.get_bits());
+}
+
+TEST(bloom_filter_empty_is_the_empty_set) {
+    BloomFilter filter(0);
+    filter.add("a");
+    CHECK(filter.get_bits().empty());
+    CHECK(!filter.maybe_contains("a"));
+    CHECK(!BloomFilter(std::string()).maybe_contains(""));
+}
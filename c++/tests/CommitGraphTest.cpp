@@ -0,0 +1,144 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <map>
+#include <cstdio>
+#include "Test.h"
+#include "../src/Files.h"
+#include "../src/Tree.h"
+#include "../src/Commit.h"
+#include "../src/CommitGraph.h"
+
+using namespace gitc;
+
+// the tests of this file share .gitc/commit-graph, each one starts from what the one before left
+
+static ObjectId make_tree(const std::map<std::string, std::string> &files) {
+    ObjectDatabase &db = ObjectDatabase::get();
+    Tree tree;
+    for (auto &file: files) tree.add_entry(file.first, db.write(file.second), Tree::BLOB);
+    return tree.write_to_file();
+}
+
+static ObjectId make_commit(const std::map<std::string, std::string> &files, const ObjectId &parent,
+                            const std::string &message) {
+    const std::string content = "tree " + make_tree(files).to_hex() + "\nparent " +
+                                (parent.is_null() ? "" : parent.to_hex()) + "\ntime 1700000000\n" + message + "\n";
+    return ObjectDatabase::get().write(content);
+}
+
+static std::string graph_path() {
+    return Files::join_path(Files::root_path(), ".gitc/commit-graph");
+}
+
+static size_t header_size(const CommitGraph &graph) {
+    return Files::file_size(graph_path()) - graph.size() * sizeof(Commit_graph_entry);
+}
+
+static ObjectId first, second, third;
+
+TEST(commit_graph_imports_a_history) {
+    first = make_commit({{"a", "1"}, {"b", "1"}}, ObjectId(), "first");
+    second = make_commit({{"a", "2"}, {"b", "1"}}, first, "second");
+    third = make_commit({{"a", "2"}, {"b", "2"}, {"c", "1"}}, second, "third");
+
+    CommitGraph graph;
+    uint32_t position = 0;
+    CHECK(graph.size() == 0);
+    CHECK(graph.lookup_or_import(third, position));
+    CHECK(position == 2);
+    CHECK(graph.size() == 3);
+
+    // parents come first
+    CHECK(graph.at(0).commit_hash == first && graph.at(0).parent == CommitGraph::NO_PARENT);
+    CHECK(graph.at(1).commit_hash == second && graph.at(1).parent == 0);
+    CHECK(graph.at(2).parent == 1 && graph.at(2).generation == 3);
+    CHECK(graph.is_ancestor(0, 2));
+    CHECK(!graph.is_ancestor(2, 0));
+}
+
+TEST(commit_graph_round_trips) {
+    CommitGraph graph;
+    CHECK(graph.size() == 3);
+
+    uint32_t position = 0;
+    CHECK(graph.lookup(second, position) && position == 1);
+    CHECK(!graph.lookup(ObjectDatabase::get().write("not a commit"), position));
+    CHECK(graph.get_message(graph.at(0)) == "first");
+    CHECK(graph.get_message(graph.at(2)) == "third");
+    CHECK(CommitGraph::get_tree_hash(graph.at(1)) == Commit(second).get_tree_hash());
+    CHECK(graph.at(1).timestamp == 1700000000);
+}
+
+TEST(commit_graph_filters_the_changed_paths) {
+    CommitGraph graph;
+
+    CHECK(graph.may_have_changed(graph.at(1), "a"));
+    CHECK(!graph.may_have_changed(graph.at(1), "b"));
+    CHECK(graph.may_have_changed(graph.at(2), "b"));
+    CHECK(graph.may_have_changed(graph.at(2), "c"));
+    CHECK(!graph.may_have_changed(graph.at(2), "a"));
+}
+
+TEST(commit_graph_cuts_a_torn_record) {
+    {
+        CommitGraph graph;
+        const size_t header = header_size(graph);
+
+        // a crash in the middle of an append leaves part of a record behind
+        FILE *file = fopen(graph_path().c_str(), "ab");
+        fwrite("torn", 1, 4, file);
+        fclose(file);
+
+        CommitGraph torn;
+        CHECK(torn.size() == 3);
+
+        uint32_t position = 0;
+        const ObjectId fourth = make_commit({{"d", "1"}}, third, "fourth");
+        CHECK(torn.lookup_or_import(fourth, position) && position == 3);
+        CHECK(Files::file_size(graph_path()) == header + 4 * sizeof(Commit_graph_entry));
+    }
+
+    CommitGraph graph;
+    CHECK(graph.size() == 4);
+    CHECK(graph.at(3).parent == 2);
+    CHECK(graph.get_message(graph.at(3)) == "fourth");
+}
+
+TEST(commit_graph_drops_records_with_a_bad_parent) {
+    std::string data;
+    Files::read_file(graph_path(), data);
+    const size_t header = data.size() - 4 * sizeof(Commit_graph_entry);
+
+    // the second record claims a parent after itself, it and everything after it are garbage
+    Commit_graph_entry entry;
+    std::memcpy(&entry, data.data() + header + sizeof entry, sizeof entry);
+    entry.parent = 3;
+    std::memcpy(&data[header + sizeof entry], &entry, sizeof entry);
+    Files::write_file(graph_path(), data);
+
+    CommitGraph graph;
+    CHECK(graph.size() == 1);
+
+    // and imported again from the objects
+    uint32_t position = 0;
+    CHECK(graph.lookup_or_import(third, position) && position == 2);
+    CHECK(graph.at(1).commit_hash == second && graph.at(1).parent == 0);
+    CHECK(Files::file_size(graph_path()) == header + 3 * sizeof(Commit_graph_entry));
+}
+
+TEST(commit_graph_waits_for_its_lock) {
+    const ObjectId fifth = make_commit({{"e", "1"}}, third, "fifth");
+    Files::write_file(graph_path() + ".lock", "");
+
+    CommitGraph graph;
+    uint32_t position = 0;
+    CHECK(!graph.lookup_or_import(fifth, position));
+    CHECK(graph.size() == 3);
+
+    Files::delete_file(graph_path() + ".lock");
+    CHECK(graph.lookup_or_import(fifth, position) && position == 3);
+    CHECK(CommitGraph().size() == 4);
+}
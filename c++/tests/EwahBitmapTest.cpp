@@ -0,0 +1,70 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "Test.h"
+#include "../src/EwahBitmap.h"
+
+using namespace gitc;
+
+static const uint64_t ALL_ONES = ~(uint64_t) 0;
+
+static bool round_trips(const std::vector<uint64_t> &words) {
+    const EwahBitmap bitmap = EwahBitmap::deserialize(EwahBitmap::compress(words).serialize());
+    return bitmap.decompress() == words;
+}
+
+TEST(ewah_round_trips) {
+    CHECK(round_trips({}));
+    CHECK(round_trips({0}));
+    CHECK(round_trips({ALL_ONES}));
+    CHECK(round_trips({5, 0, 0, 0, ALL_ONES, ALL_ONES, 7, 9, 0}));
+    CHECK(round_trips({0, 0, 0, 1, 2, 3, ALL_ONES, 0, ALL_ONES, 42}));
+
+    std::vector<uint64_t> sparse(1000, 0);
+    sparse[3] = 1;
+    sparse[500] = ALL_ONES;
+    sparse[999] = (uint64_t) 1 << 63;
+    CHECK(round_trips(sparse));
+}
+
+TEST(ewah_compresses_runs) {
+    const std::vector<uint64_t> words(10000, 0);
+    CHECK(EwahBitmap::compress(words).serialize().size() == sizeof(uint64_t));
+    CHECK(round_trips(words));
+
+    const std::vector<uint64_t> ones(10000, ALL_ONES);
+    CHECK(EwahBitmap::compress(ones).serialize().size() == sizeof(uint64_t));
+    CHECK(round_trips(ones));
+}
+
+TEST(ewah_or_into_grows_and_reports_new_bits) {
+    std::vector<uint64_t> words = {0x1};
+    std::vector<size_t> added;
+
+    EwahBitmap::compress({0x3, 0, ALL_ONES}).or_into(words, &added);
+    CHECK(words.size() == 3);
+    CHECK(words[0] == 0x3 && words[1] == 0 && words[2] == ALL_ONES);
+
+    // bit 0 was set before, so only bit 1 and the 64 bits of the third word are new
+    CHECK(added.size() == 65);
+    CHECK(!added.empty() && added.front() == 1);
+    CHECK(!added.empty() && added.back() == 3 * 64 - 1);
+
+    // nothing new the second time
+    added.clear();
+    EwahBitmap::compress({0x3, 0, ALL_ONES}).or_into(words, &added);
+    CHECK(added.empty());
+}
+
+TEST(ewah_ignores_a_truncated_buffer) {
+    std::string data = EwahBitmap::compress({1, 2, 3, 4}).serialize();
+    data.resize(data.size() - sizeof(uint64_t) - 3);
+
+    // the marker promises four literals, only the whole ones that are there are read
+    const std::vector<uint64_t> words = EwahBitmap::deserialize(data).decompress();
+    CHECK(words == std::vector<uint64_t>({1, 2, 0, 0}));
+}
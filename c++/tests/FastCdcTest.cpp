@@ -0,0 +1,128 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <vector>
+#include <set>
+#include <sstream>
+#include <cstdint>
+#include "Test.h"
+#include "../src/FastCdc.h"
+#include "../src/Blob.h"
+#include "../src/Sha256.h"
+
+using namespace gitc;
+
+// the same bytes on every run, random enough for the gear hash
+static std::string random_bytes(size_t size, uint64_t seed) {
+    std::string bytes(size, '\0');
+    uint64_t state = seed;
+    for (char &byte: bytes) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        byte = (char) (state >> 56);
+    }
+    return bytes;
+}
+
+static std::vector<std::string> chunk(const std::string &data) {
+    std::vector<std::string> chunks;
+    for (size_t start = 0; start < data.size();) {
+        const size_t length = FastCdc::cut(reinterpret_cast<const unsigned char *>(data.data()) + start,
+                                           data.size() - start);
+        chunks.push_back(data.substr(start, length));
+        start += length;
+    }
+    return chunks;
+}
+
+TEST(fastcdc_short_input_is_one_chunk) {
+    const std::string data = random_bytes(FastCdc::MIN_SIZE, 1);
+    CHECK(FastCdc::cut(reinterpret_cast<const unsigned char *>(data.data()), data.size()) == data.size());
+    CHECK(FastCdc::cut(reinterpret_cast<const unsigned char *>(data.data()), 0) == 0);
+}
+
+TEST(fastcdc_chunk_sizes_are_bounded) {
+    const std::string data = random_bytes(8 * 1024 * 1024, 2);
+    const std::vector<std::string> chunks = chunk(data);
+
+    bool bounded = true;
+    size_t total = 0;
+    for (size_t i = 0; i < chunks.size(); i++) {
+        bounded &= chunks[i].size() <= FastCdc::MAX_SIZE && (i + 1 == chunks.size() || chunks[i].size() > FastCdc::MIN_SIZE);
+        total += chunks[i].size();
+    }
+
+    CHECK(bounded);
+    CHECK(total == data.size());
+
+    // the masks keep the average near AVERAGE_SIZE
+    const size_t average = data.size() / chunks.size();
+    CHECK(average > FastCdc::AVERAGE_SIZE / 2 && average < FastCdc::AVERAGE_SIZE * 2);
+}
+
+TEST(fastcdc_all_zeros_cuts_at_max_size) {
+    const std::string data(3 * FastCdc::MAX_SIZE, '\0');
+    const std::vector<std::string> chunks = chunk(data);
+    CHECK(chunks.size() == 3);
+    CHECK(!chunks.empty() && chunks[0].size() == FastCdc::MAX_SIZE);
+}
+
+TEST(fastcdc_an_insert_only_changes_nearby_chunks) {
+    const std::string data = random_bytes(4 * 1024 * 1024, 3);
+    std::string edited = data;
+    edited.insert(1024 * 1024, "an edit in the middle");
+
+    const std::vector<std::string> before = chunk(data), after = chunk(edited);
+    const std::set<std::string> old_chunks(before.begin(), before.end());
+
+    size_t changed = 0;
+    for (const std::string &piece: after) changed += old_chunks.count(piece) == 0;
+    CHECK(changed <= 2);
+}
+
+TEST(blob_small_file_is_one_object) {
+    Files::write_file("blob-small", "hello\n");
+
+    Tree::Entry_type type;
+    const ObjectId id = Blob::store("blob-small", type);
+    CHECK(type == Tree::BLOB);
+    CHECK(id == Sha256::hash("hello\n"));
+
+    std::ostringstream out;
+    CHECK(Blob::write_to(id, type, out));
+    CHECK(out.str() == "hello\n");
+    Files::delete_file("blob-small");
+}
+
+TEST(blob_large_file_round_trips_through_its_chunks) {
+    const std::string data = random_bytes(CHUNKING_THRESHOLD + 1024 * 1024, 4);
+    Files::write_file("blob-large", data);
+
+    Tree::Entry_type type;
+    const ObjectId id = Blob::store("blob-large", type);
+    CHECK(type == Tree::CHUNKED);
+
+    std::vector<ObjectId> chunks;
+    CHECK(Blob::read_chunks(id, chunks));
+    CHECK(chunks.size() > 1);
+
+    std::ostringstream out;
+    CHECK(Blob::write_to(id, type, out));
+    CHECK(out.str() == data);
+
+    // the same file gives the same manifest
+    Tree::Entry_type again_type;
+    CHECK(Blob::store("blob-large", again_type) == id);
+    Files::delete_file("blob-large");
+}
+
+TEST(blob_missing_chunk_fails_the_read) {
+    std::vector<ObjectId> chunks;
+    CHECK(!Blob::read_chunks(Sha256::hash("not a manifest"), chunks));
+
+    std::ostringstream out;
+    CHECK(!Blob::write_to(Sha256::hash("not an object"), Tree::BLOB, out));
+}
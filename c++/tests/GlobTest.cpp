@@ -0,0 +1,85 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include "Test.h"
+#include "../src/Glob.h"
+
+using namespace gitc;
+
+TEST(glob_matches_literal_characters) {
+    CHECK(Glob("a.txt").matches("a.txt"));
+    CHECK(!Glob("a.txt").matches("a.txt2"));
+    CHECK(!Glob("a.txt").matches("b.txt"));
+    CHECK(Glob("").matches(""));
+    CHECK(!Glob("").matches("a"));
+}
+
+TEST(glob_star_stops_at_slash) {
+    const Glob glob("src/*.h");
+    CHECK(glob.matches("src/Files.h"));
+    CHECK(glob.matches("src/.h"));
+    CHECK(!glob.matches("src/lib/Files.h"));
+    CHECK(!glob.matches("src/Files.cpp"));
+}
+
+TEST(glob_star_matches_slash_when_asked) {
+    const Glob glob("*.h", true);
+    CHECK(glob.matches("Files.h"));
+    CHECK(glob.matches("src/lib/Files.h"));
+    CHECK(!glob.matches("src/Files.hpp"));
+}
+
+TEST(glob_double_star_crosses_directories) {
+    const Glob leading("**/Files.h");
+    CHECK(leading.matches("Files.h"));
+    CHECK(leading.matches("src/Files.h"));
+    CHECK(leading.matches("a/b/c/Files.h"));
+    CHECK(!leading.matches("a/bFiles.h"));
+
+    const Glob middle("a/**/b");
+    CHECK(middle.matches("a/b"));
+    CHECK(middle.matches("a/x/b"));
+    CHECK(middle.matches("a/x/y/b"));
+    CHECK(!middle.matches("a/xb"));
+
+    const Glob trailing("a/**");
+    CHECK(trailing.matches("a/b"));
+    CHECK(trailing.matches("a/b/c"));
+    CHECK(!trailing.matches("b/c"));
+}
+
+TEST(glob_question_mark_and_classes) {
+    CHECK(Glob("?.c").matches("a.c"));
+    CHECK(!Glob("?.c").matches("/.c"));
+    CHECK(!Glob("?.c").matches("ab.c"));
+
+    const Glob range("file[0-9].txt");
+    CHECK(range.matches("file7.txt"));
+    CHECK(!range.matches("filex.txt"));
+
+    const Glob negated("file[!0-9].txt");
+    CHECK(negated.matches("filex.txt"));
+    CHECK(!negated.matches("file7.txt"));
+    CHECK(!negated.matches("file/.txt"));
+
+    // a ] right after the [ is part of the class
+    CHECK(Glob("[]a]").matches("]"));
+    CHECK(Glob("[]a]").matches("a"));
+}
+
+TEST(glob_escapes_and_unclosed_classes) {
+    CHECK(Glob("a\\*b").matches("a*b"));
+    CHECK(!Glob("a\\*b").matches("axb"));
+    CHECK(Glob("a[b").matches("a[b"));
+    CHECK(Glob::has_wildcards("a?b"));
+    CHECK(!Glob::has_wildcards("a/b.c"));
+}
+
+TEST(glob_many_stars_stay_linear) {
+    // a backtracking matcher takes exponential time on this, the automaton a pass over the text
+    const std::string text(200, 'a');
+    CHECK(!Glob("*a*a*a*a*a*a*a*a*a*a*b").matches(text));
+    CHECK(Glob("*a*a*a*a*a*a*a*a*a*a").matches(text));
+}
@@ -0,0 +1,148 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <map>
+#include <vector>
+#include "Test.h"
+#include "../src/Files.h"
+#include "../src/Sha256.h"
+#include "../src/Index.h"
+
+using namespace gitc;
+
+// the tests of this file share .gitc/index, each one starts from what the one before left
+
+static const int FILES = 20;
+
+static std::string file_path(int i) {
+    return "index-test/f" + std::to_string(10 + i);
+}
+
+static std::string index_path() {
+    return Files::join_path(Files::root_path(), ".gitc/index");
+}
+
+static std::string index_header() {
+    std::string content;
+    Files::read_file(index_path(), content);
+    return content.substr(0, content.find('\n'));
+}
+
+static size_t shared_index_count() {
+    size_t count = 0;
+    for (const std::string &path: Files::ls_recursive(Files::join_path(Files::root_path(), ".gitc"))) {
+        count += path.find("sharedindex.") != std::string::npos;
+    }
+    return count;
+}
+
+// the tracked entries of the index as it is on disk
+static std::map<std::string, Tracked_file> tracked() {
+    std::map<std::string, Tracked_file> files;
+    Index index;
+    for (size_t i = 0; i < index.size(); i++) {
+        if (index.get_stage(i) != UNTRACKED) files[index.get_path(i)] = {index.get_hash(i), index.get_type(i)};
+    }
+    return files;
+}
+
+TEST(index_folds_a_first_write_into_a_base) {
+    for (int i = 0; i < FILES; i++) {
+        Files::make_parent_dirs(file_path(i));
+        Files::write_file(file_path(i), "version 1 of " + std::to_string(i));
+    }
+
+    {
+        Index index;
+        for (int i = 0; i < FILES; i++) index.update(file_path(i), ADD);
+    }
+
+    // the split index starts out empty, everything is in the base
+    CHECK(index_header().compare(0, 25, "0 gitc_version_1.1_split ") == 0);
+    CHECK(shared_index_count() == 1);
+
+    const std::map<std::string, Tracked_file> files = tracked();
+    CHECK(files.size() == FILES);
+
+    bool all_match = true;
+    for (int i = 0; i < FILES; i++) {
+        auto file = files.find(file_path(i));
+        all_match &= file != files.end() && file->second.hash == Sha256::hash("version 1 of " + std::to_string(i)) &&
+                     file->second.type == Tree::BLOB;
+    }
+    CHECK(all_match);
+}
+
+TEST(index_writes_only_the_delta) {
+    Files::write_file(file_path(3), "version 2");
+    {
+        Index index;
+        index.update(file_path(3), ADD);
+    }
+
+    CHECK(index_header().compare(0, 25, "1 gitc_version_1.1_split ") == 0);
+    CHECK(shared_index_count() == 1);
+
+    const std::map<std::string, Tracked_file> files = tracked();
+    CHECK(files.size() == FILES);
+    CHECK(files.count(file_path(3)) && files.at(file_path(3)).hash == Sha256::hash("version 2"));
+    CHECK(files.count(file_path(4)) && files.at(file_path(4)).hash == Sha256::hash("version 1 of 4"));
+
+    // reading an index that didn't change doesn't write it
+    const std::string before = index_header();
+    { Index index; }
+    CHECK(index_header() == before);
+}
+
+TEST(index_records_deleted_base_entries) {
+    Files::delete_file(file_path(5));
+    Files::write_file(file_path(3), "version 3");
+    {
+        Index index;
+        index.update(file_path(3), ADD);
+    }
+
+    // the delta has the changed file and the deleted one, still within a tenth of the base
+    CHECK(index_header().compare(0, 25, "2 gitc_version_1.1_split ") == 0);
+
+    const std::map<std::string, Tracked_file> files = tracked();
+    CHECK(files.size() == FILES - 1);
+    CHECK(files.count(file_path(5)) == 0);
+    CHECK(files.count(file_path(3)) && files.at(file_path(3)).hash == Sha256::hash("version 3"));
+}
+
+TEST(index_folds_a_large_delta_into_a_new_base) {
+    for (int i = 6; i < 9; i++) Files::write_file(file_path(i), "version 2");
+    {
+        Index index;
+        for (int i = 6; i < 9; i++) index.update(file_path(i), ADD);
+    }
+
+    // the old base is deleted with it
+    CHECK(index_header().compare(0, 25, "0 gitc_version_1.1_split ") == 0);
+    CHECK(shared_index_count() == 1);
+
+    const std::map<std::string, Tracked_file> files = tracked();
+    CHECK(files.size() == FILES - 1);
+    CHECK(files.count(file_path(7)) && files.at(file_path(7)).hash == Sha256::hash("version 2"));
+    CHECK(files.count(file_path(9)) && files.at(file_path(9)).hash == Sha256::hash("version 1 of 9"));
+}
+
+TEST(index_untracked_files_are_not_written) {
+    Files::write_file("index-test/untracked", "new");
+    {
+        Index index;
+        CHECK(index.has_untracked_files());
+        index.update(file_path(9), REMOVE);
+    }
+
+    std::string content;
+    Files::read_file(index_path(), content);
+    CHECK(content.find("index-test/untracked") == std::string::npos);
+
+    const std::map<std::string, Tracked_file> files = tracked();
+    CHECK(files.count(file_path(9)) == 0);
+    CHECK(files.count("index-test/untracked") == 0);
+}
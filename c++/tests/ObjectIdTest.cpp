@@ -0,0 +1,89 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <vector>
+#include "Test.h"
+#include "../src/ObjectId.h"
+#include "../src/Sha256.h"
+#include "../src/ObjectDatabase.h"
+#include "../src/Abbreviation.h"
+
+using namespace gitc;
+
+// an id whose hex starts with prefix and is 0 after it
+static ObjectId id_with_prefix(const std::string &prefix) {
+    ObjectId id;
+    ObjectId::from_hex_prefix(prefix, id);
+    return id;
+}
+
+TEST(sha256_known_digests) {
+    CHECK(Sha256::hash("").to_hex() == "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    CHECK(Sha256::hash("abc").to_hex() == "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    CHECK(Sha256::hash("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq").to_hex() ==
+          "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    CHECK(Sha256::hash(std::string(1000000, 'a')).to_hex() ==
+          "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+}
+
+TEST(object_id_hex_round_trips) {
+    const ObjectId id = Sha256::hash("abc");
+    CHECK(ObjectId::from_hex(id.to_hex()) == id);
+    CHECK(ObjectId().is_null());
+    CHECK(!id.is_null());
+}
+
+TEST(object_id_rejects_bad_hex) {
+    const std::string hex = Sha256::hash("abc").to_hex();
+    CHECK(ObjectId::from_hex(hex.substr(1)).is_null());
+    CHECK(ObjectId::from_hex(hex + "0").is_null());
+    CHECK(ObjectId::from_hex("g" + hex.substr(1)).is_null());
+
+    ObjectId prefix;
+    CHECK(!ObjectId::from_hex_prefix("", prefix));
+    CHECK(!ObjectId::from_hex_prefix("12x", prefix));
+    CHECK(!ObjectId::from_hex_prefix(hex + "0", prefix));
+    CHECK(ObjectId::from_hex_prefix("ABC", prefix));
+}
+
+TEST(object_id_prefixes) {
+    const ObjectId id = ObjectId::from_hex("abc1230000000000000000000000000000000000000000000000000000000000");
+    ObjectId prefix;
+
+    CHECK(ObjectId::from_hex_prefix("abc", prefix) && id.has_hex_prefix(prefix, 3));
+    CHECK(ObjectId::from_hex_prefix("abc12", prefix) && id.has_hex_prefix(prefix, 5));
+    CHECK(ObjectId::from_hex_prefix("abd", prefix) && !id.has_hex_prefix(prefix, 3));
+    CHECK(ObjectId::from_hex_prefix("abc2", prefix) && !id.has_hex_prefix(prefix, 4));
+    CHECK(id.common_hex_digits(id_with_prefix("abc124")) == 5);
+    CHECK(id.common_hex_digits(id) == ObjectId::HEX_SIZE);
+}
+
+TEST(abbreviation_finds_by_prefix) {
+    MemoryObjectDatabase db;
+    db.write(id_with_prefix("abcd1"), "1");
+    db.write(id_with_prefix("abcd2"), "2");
+    db.write(id_with_prefix("abce"), "3");
+
+    CHECK(Abbreviation::find("abcd", db).size() == 2);
+    CHECK(Abbreviation::find("abcd1", db).size() == 1);
+    CHECK(Abbreviation::find("abc", db).size() == 3);
+    CHECK(Abbreviation::find("ffff", db).empty());
+    CHECK(Abbreviation::find("xyz", db).empty());
+}
+
+TEST(abbreviation_shortest_unique) {
+    MemoryObjectDatabase db;
+    const ObjectId a = id_with_prefix("1234567801");
+    const ObjectId b = id_with_prefix("1234567802");
+    const ObjectId c = id_with_prefix("ff");
+    db.write(a, "a");
+    db.write(b, "b");
+    db.write(c, "c");
+
+    const std::vector<size_t> lengths = Abbreviation::shortest_unique({a, b, c}, db);
+    CHECK(lengths.size() == 3);
+    CHECK(lengths.size() == 3 && lengths[0] == 10 && lengths[1] == 10);
+    CHECK(lengths.size() == 3 && lengths[2] == Abbreviation::MIN_LENGTH);
+}
@@ -0,0 +1,120 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include "Test.h"
+#include "../src/Files.h"
+#include "../src/Sha256.h"
+#include "../src/ObjectDatabase.h"
+
+using namespace gitc;
+
+TEST(pack_round_trips_its_objects) {
+    const std::string pack_dir = "pack-round-trip";
+    std::vector<std::string> contents = {"", "a", std::string(100000, 'x'), std::string("with\0nul", 8)};
+    for (int i = 0; i < 100; i++) contents.push_back("object " + std::to_string(i));
+
+    {
+        PackObjectDatabase pack(pack_dir);
+        ObjectDatabase &db = pack;
+        for (const std::string &content: contents) db.write(content);
+
+        // buffered until flush, but readable already
+        std::string read;
+        CHECK(db.read(Sha256::hash("a"), read) && read == "a");
+        CHECK(pack.get_packs().empty());
+    }
+
+    PackObjectDatabase pack(pack_dir);
+    CHECK(pack.get_packs().size() == 1);
+
+    bool all_read = true;
+    for (const std::string &content: contents) {
+        std::string read;
+        all_read &= pack.read(Sha256::hash(content), read) && read == content;
+    }
+    CHECK(all_read);
+
+    std::vector<ObjectId> ids;
+    pack.list(ids);
+    CHECK(ids.size() == contents.size());
+    CHECK(std::is_sorted(ids.begin(), ids.end()));
+    CHECK(pack.get_pack_ids(0) == ids);
+
+    std::string read;
+    CHECK(!pack.read(Sha256::hash("missing"), read));
+    CHECK(!pack.exists(Sha256::hash("missing")));
+}
+
+TEST(pack_find_prefix_looks_at_the_sorted_range) {
+    PackObjectDatabase pack("pack-round-trip");
+    const ObjectId id = Sha256::hash("object 7");
+
+    ObjectId prefix;
+    ObjectId::from_hex_prefix(id.to_hex().substr(0, 6), prefix);
+
+    std::vector<ObjectId> found;
+    pack.find_prefix(prefix, 6, found);
+    CHECK(std::find(found.begin(), found.end(), id) != found.end());
+
+    bool all_match = true;
+    for (const ObjectId &other: found) all_match &= other.has_hex_prefix(prefix, 6);
+    CHECK(all_match);
+}
+
+TEST(pack_flush_adds_a_second_pack) {
+    const std::string pack_dir = "pack-two";
+    {
+        PackObjectDatabase pack(pack_dir);
+        ObjectDatabase &db = pack;
+        db.write("first");
+        pack.flush();
+        CHECK(pack.get_packs().size() == 1);
+
+        // an object that is already packed isn't written again
+        db.write("first");
+        db.write("second");
+    }
+
+    PackObjectDatabase pack(pack_dir);
+    CHECK(pack.get_packs().size() == 2);
+    CHECK(pack.exists(Sha256::hash("first")) && pack.exists(Sha256::hash("second")));
+
+    std::vector<ObjectId> ids;
+    pack.list(ids);
+    CHECK(ids.size() == 2);
+}
+
+TEST(pack_ignores_broken_indexes) {
+    const std::string pack_dir = "pack-broken";
+    std::string name;
+    {
+        PackObjectDatabase pack(pack_dir);
+        ObjectDatabase &db = pack;
+        db.write("one");
+        db.write("two");
+        db.write("three");
+        pack.flush();
+        name = pack.get_packs().at(0);
+    }
+
+    // an index cut in the middle of its third entry only has the first two
+    std::string index;
+    Files::read_file(name + ".idx", index);
+    Files::write_file(name + ".idx", index.substr(0, index.size() - 10));
+    {
+        PackObjectDatabase pack(pack_dir);
+        std::vector<ObjectId> ids;
+        pack.list(ids);
+        CHECK(ids.size() == 2);
+    }
+
+    // and one with the wrong magic is no index at all
+    Files::write_file(name + ".idx", "XIDX" + index.substr(4));
+    PackObjectDatabase pack(pack_dir);
+    CHECK(pack.get_packs().empty());
+    CHECK(!pack.exists(Sha256::hash("one")));
+}
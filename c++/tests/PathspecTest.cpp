@@ -0,0 +1,123 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <vector>
+#include "Test.h"
+#include "../src/Pathspec.h"
+
+using namespace gitc;
+
+TEST(pathspec_empty_matches_everything) {
+    const Pathspec pathspec;
+    CHECK(pathspec.is_empty());
+    CHECK(pathspec.matches("a/b"));
+    CHECK(pathspec.may_match_below("a"));
+    CHECK(pathspec.walk_root() == ".");
+}
+
+TEST(pathspec_literal_matches_itself_and_below) {
+    const Pathspec pathspec({"src/lib", "README"});
+    CHECK(pathspec.matches("src/lib"));
+    CHECK(pathspec.matches("src/lib/a.cpp"));
+    CHECK(pathspec.matches("README"));
+    CHECK(!pathspec.matches("src/library"));
+    CHECK(!pathspec.matches("README.md"));
+    CHECK(!pathspec.matches("src"));
+
+    CHECK(pathspec.may_match_below("src"));
+    CHECK(pathspec.may_match_below("src/lib/deep"));
+    CHECK(!pathspec.may_match_below("docs"));
+    CHECK(!pathspec.may_match_below("src/other"));
+}
+
+TEST(pathspec_leading_dot_and_trailing_slash) {
+    const Pathspec pathspec({"./src/"});
+    CHECK(pathspec.matches("src/a.cpp"));
+    CHECK(pathspec.matches("./src/a.cpp"));
+    CHECK(pathspec.walk_root() == "src");
+
+    std::string path;
+    CHECK(pathspec.is_single_path(path));
+    CHECK(path == "src");
+}
+
+TEST(pathspec_glob_star_crosses_directories) {
+    const Pathspec pathspec({"*.h"});
+    CHECK(pathspec.matches("Files.h"));
+    CHECK(pathspec.matches("src/Files.h"));
+    CHECK(!pathspec.matches("src/Files.cpp"));
+    CHECK(pathspec.may_match_below("src"));
+
+    std::string path;
+    CHECK(!pathspec.is_single_path(path));
+}
+
+TEST(pathspec_glob_magic_star_stops_at_slash) {
+    const Pathspec pathspec({":(glob)src/*.h"});
+    CHECK(pathspec.matches("src/Files.h"));
+    CHECK(!pathspec.matches("src/lib/Files.h"));
+    CHECK(!pathspec.matches("Files.h"));
+
+    // the literal prefix turns down directories the glob can't reach
+    CHECK(pathspec.may_match_below("src"));
+    CHECK(!pathspec.may_match_below("lib"));
+    CHECK(!pathspec.may_match_below("sr"));
+    CHECK(pathspec.walk_root() == "src");
+}
+
+TEST(pathspec_literal_magic_has_no_wildcards) {
+    const Pathspec pathspec({":(literal)a*b"});
+    CHECK(pathspec.matches("a*b"));
+    CHECK(!pathspec.matches("axb"));
+}
+
+TEST(pathspec_icase) {
+    const Pathspec pathspec({":(icase)Src/README"});
+    CHECK(pathspec.matches("src/readme"));
+    CHECK(pathspec.matches("SRC/ReadMe/x"));
+    CHECK(!pathspec.matches("src/readme2"));
+    CHECK(pathspec.walk_root() == ".");
+}
+
+TEST(pathspec_excludes) {
+    const Pathspec pathspec({"src", ":(exclude)src/generated", ":!*.o"});
+    CHECK(pathspec.matches("src/a.cpp"));
+    CHECK(!pathspec.matches("src/generated/a.cpp"));
+    CHECK(!pathspec.matches("src/a.o"));
+    CHECK(!pathspec.matches("docs/a.cpp"));
+
+    CHECK(!pathspec.may_match_below("src/generated"));
+    CHECK(pathspec.may_match_below("src/other"));
+    CHECK(pathspec.rejected_directory("src/generated/deep/a.cpp") == std::string("src/generated").size());
+    CHECK(pathspec.rejected_directory("src/a/b.cpp") == 0);
+}
+
+TEST(pathspec_only_excludes_match_the_rest) {
+    const Pathspec pathspec({":^build"});
+    CHECK(pathspec.matches("src/a.cpp"));
+    CHECK(!pathspec.matches("build/a.o"));
+    CHECK(!pathspec.may_match_below("build"));
+    CHECK(pathspec.may_match_below("src"));
+}
+
+TEST(pathspec_top_magic) {
+    CHECK(Pathspec({":/src"}).matches("src/a.cpp"));
+    CHECK(Pathspec({":(top)src"}).matches("src/a.cpp"));
+}
+
+TEST(pathspec_reports_unmatched_includes) {
+    const Pathspec pathspec({"a", "b/*.c", ":!c"});
+    pathspec.matches("a/x");
+
+    const std::vector<std::string> unmatched = pathspec.unmatched();
+    CHECK(unmatched.size() == 1);
+    CHECK(!unmatched.empty() && unmatched[0] == "b/*.c");
+}
+
+TEST(pathspec_walk_root_is_the_common_directory) {
+    CHECK(Pathspec({"src/lib/a.cpp", "src/lib/b.cpp"}).walk_root() == "src/lib");
+    CHECK(Pathspec({"src/lib", "src/library"}).walk_root() == "src");
+    CHECK(Pathspec({"src/a", "docs/b"}).walk_root() == ".");
+}
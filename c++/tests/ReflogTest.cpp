@@ -0,0 +1,133 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include "Test.h"
+#include "../src/Files.h"
+#include "../src/Sha256.h"
+#include "../src/Reflog.h"
+
+using namespace gitc;
+
+static const size_t HEADER_SIZE = 8;
+static const size_t RECORD_SIZE = 2 * ObjectId::SIZE + 24;
+static const size_t TIMESTAMP_OFFSET = 2 * ObjectId::SIZE;
+
+static std::string records_path(const std::string &ref) {
+    return Files::join_path(Files::root_path(), ".gitc/logs/records/" + ref);
+}
+
+static std::vector<std::string> messages_of(const std::string &ref) {
+    std::vector<std::string> messages;
+    Reflog::scan_reverse(ref, [&messages](const Reflog_entry &entry) {
+        messages.emplace_back(entry.message);
+        return true;
+    });
+    return messages;
+}
+
+static ObjectId id(int i) {
+    return Sha256::hash(std::to_string(i));
+}
+
+TEST(reflog_scans_newest_first) {
+    const std::string ref = "refs/heads/scan";
+    CHECK(Reflog::append(ref, ObjectId(), id(1), "commit: one"));
+    CHECK(Reflog::append(ref, id(1), id(2), "commit: two"));
+    CHECK(Reflog::append(ref, id(2), id(3), ""));
+
+    CHECK(messages_of(ref) == std::vector<std::string>({"", "commit: two", "commit: one"}));
+    CHECK(Files::file_size(records_path(ref)) == HEADER_SIZE + 3 * RECORD_SIZE);
+
+    std::vector<Reflog_entry> entries;
+    Reflog::scan_reverse(ref, [&entries](const Reflog_entry &entry) {
+        entries.push_back(entry);
+        return entries.size() < 2;
+    });
+    CHECK(entries.size() == 2);
+    CHECK(entries.size() == 2 && entries[0].new_hash == id(3) && entries[0].old_hash == id(2));
+    CHECK(entries.size() == 2 && entries[1].new_hash == id(2));
+}
+
+TEST(reflog_missing_or_foreign_file_is_empty) {
+    CHECK(messages_of("refs/heads/none").empty());
+
+    Files::make_parent_dirs(records_path("refs/heads/foreign"));
+    Files::write_file(records_path("refs/heads/foreign"), "0000 1111 text reflog\n");
+    CHECK(messages_of("refs/heads/foreign").empty());
+    Reflog::remove("refs/heads/foreign");
+}
+
+TEST(reflog_cuts_a_torn_record) {
+    const std::string ref = "refs/heads/torn";
+    CHECK(Reflog::append(ref, ObjectId(), id(1), "one"));
+
+    FILE *file = fopen(records_path(ref).c_str(), "ab");
+    fwrite("torn", 1, 4, file);
+    fclose(file);
+
+    // the torn record is left out, and cut off by the next append
+    CHECK(messages_of(ref) == std::vector<std::string>({"one"}));
+    CHECK(Reflog::append(ref, id(1), id(2), "two"));
+    CHECK(Files::file_size(records_path(ref)) == HEADER_SIZE + 2 * RECORD_SIZE);
+    CHECK(messages_of(ref) == std::vector<std::string>({"two", "one"}));
+}
+
+TEST(reflog_takes_back_the_last_entry) {
+    const std::string ref = "refs/heads/taken-back";
+    CHECK(Reflog::append(ref, ObjectId(), id(1), "one"));
+    CHECK(Reflog::append(ref, id(1), id(2), "two"));
+
+    Reflog::remove_last(ref);
+    CHECK(messages_of(ref) == std::vector<std::string>({"one"}));
+    Reflog::remove_last(ref);
+    CHECK(messages_of(ref).empty());
+
+    // nothing left to take back
+    Reflog::remove_last(ref);
+    CHECK(Files::file_size(records_path(ref)) == HEADER_SIZE);
+}
+
+TEST(reflog_expires_the_oldest_entries) {
+    const std::string ref = "refs/heads/expire";
+    for (int i = 0; i < 5; i++) CHECK(Reflog::append(ref, id(i), id(i + 1), "entry " + std::to_string(i)));
+
+    // the first three are a year old
+    std::string data;
+    Files::read_file(records_path(ref), data);
+    const uint64_t old_time = (uint64_t) time(nullptr) - 365 * 24 * 60 * 60;
+    for (size_t i = 0; i < 3; i++) std::memcpy(&data[HEADER_SIZE + i * RECORD_SIZE + TIMESTAMP_OFFSET], &old_time, sizeof old_time);
+    Files::write_file(records_path(ref), data);
+
+    CHECK(Reflog::expire(ref, 0) == 0);
+    CHECK(Reflog::expire(ref, time(nullptr) - REFLOG_EXPIRE) == 3);
+
+    // the messages keep their offsets, the ones that are kept still read back
+    CHECK(messages_of(ref) == std::vector<std::string>({"entry 4", "entry 3"}));
+    CHECK(Reflog::append(ref, id(5), id(6), "entry 5"));
+    CHECK(messages_of(ref) == std::vector<std::string>({"entry 5", "entry 4", "entry 3"}));
+
+    // expiring everything removes the reflog
+    CHECK(Reflog::expire(ref, time(nullptr) + 60) == 3);
+    CHECK(!Files::file_exists(records_path(ref)));
+}
+
+TEST(reflog_lists_its_refs) {
+    Reflog::append("refs/tags/v1", ObjectId(), id(1), "tag");
+
+    // a temporary next to a reflog is no ref
+    Files::write_file(records_path("refs/tags/v1..abcdef"), "");
+
+    const std::vector<std::string> refs = Reflog::list_refs();
+    CHECK(std::find(refs.begin(), refs.end(), "refs/tags/v1") != refs.end());
+    CHECK(std::find(refs.begin(), refs.end(), "refs/heads/scan") != refs.end());
+    CHECK(std::find(refs.begin(), refs.end(), "refs/tags/v1..abcdef") == refs.end());
+    CHECK(std::find(refs.begin(), refs.end(), "refs/heads/expire") == refs.end());
+
+    Files::delete_file(records_path("refs/tags/v1..abcdef"));
+}
@@ -0,0 +1,177 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <vector>
+#include "Test.h"
+#include "../src/Files.h"
+#include "../src/Sha256.h"
+#include "../src/Refs.h"
+
+using namespace gitc;
+
+// Refs maps packed-refs the first time it's needed, so the hand written one has to come first
+
+static ObjectId id(const std::string &name) {
+    return Sha256::hash(name);
+}
+
+static std::string gitc_path(const std::string &path) {
+    return Files::join_path(Files::root_path(), ".gitc/" + path);
+}
+
+static size_t reflog_size(const std::string &ref) {
+    size_t count = 0;
+    Reflog::scan_reverse(ref, [&count](const Reflog_entry &) {
+        count++;
+        return true;
+    });
+    return count;
+}
+
+TEST(refs_binary_search_packed_refs) {
+    std::vector<std::string> names;
+    for (int i = 0; i < 100; i++) names.push_back("refs/heads/branch" + std::to_string(1000 + i));
+    names.push_back("refs/tags/v1");
+
+    std::string content = "# pack-refs with: sorted\n";
+    for (const std::string &name: names) content += id(name).to_hex() + " " + name + "\n";
+    // a file cut short in the middle of its last line
+    content += id("cut").to_hex().substr(0, 20);
+    Files::write_file(gitc_path("packed-refs"), content);
+
+    Refs &refs = Refs::get();
+    bool all_read = true;
+    for (const std::string &name: names) {
+        ObjectId hash;
+        all_read &= refs.read(name, hash) && hash == id(name);
+    }
+    CHECK(all_read);
+
+    ObjectId hash;
+    CHECK(!refs.read("refs/heads/branch0999", hash));
+    CHECK(!refs.read("refs/heads/branch1100", hash));
+    CHECK(!refs.read("refs/heads/branch100", hash));
+    CHECK(!refs.read("refs/tags/v2", hash));
+}
+
+TEST(refs_list_a_prefix_of_packed_refs) {
+    const std::vector<Refs::Ref> branches = Refs::get().list("refs/heads/");
+    CHECK(branches.size() == 100);
+    CHECK(branches.size() == 100 && branches.front().name == "refs/heads/branch1000");
+    CHECK(branches.size() == 100 && branches.back().name == "refs/heads/branch1099");
+
+    // the truncated line is skipped
+    const std::vector<Refs::Ref> tags = Refs::get().list("refs/tags/");
+    CHECK(tags.size() == 1 && tags[0].name == "refs/tags/v1" && tags[0].hash == id("refs/tags/v1"));
+}
+
+TEST(refs_resolve_short_names) {
+    std::string ref;
+    ObjectId hash;
+    CHECK(Refs::get().resolve("v1", ref, hash) && ref == "refs/tags/v1");
+    CHECK(Refs::get().resolve("branch1042", ref, hash) && ref == "refs/heads/branch1042");
+    CHECK(Refs::get().resolve("refs/heads/branch1042", ref, hash) && hash == id("refs/heads/branch1042"));
+    CHECK(!Refs::get().resolve("missing", ref, hash));
+    CHECK(!Refs::get().resolve("../packed-refs", ref, hash));
+}
+
+TEST(refs_update_compares_and_swaps) {
+    Refs &refs = Refs::get();
+    const std::string ref = "refs/heads/cas";
+
+    CHECK(refs.update(ref, id("1"), ObjectId(), "create"));
+    CHECK(!refs.update(ref, id("2"), ObjectId(), "create again"));
+    CHECK(!refs.update(ref, id("2"), id("0"), "wrong expected"));
+    CHECK(refs.update(ref, id("2"), id("1"), "move"));
+
+    ObjectId hash;
+    CHECK(refs.read(ref, hash) && hash == id("2"));
+    CHECK(reflog_size(ref) == 2);
+    CHECK(!Files::file_exists(gitc_path(ref + ".lock")));
+}
+
+TEST(refs_loose_ref_wins_over_packed) {
+    Refs &refs = Refs::get();
+    const std::string ref = "refs/heads/branch1050";
+
+    CHECK(refs.update(ref, id("new"), id(ref), "move a packed ref"));
+    ObjectId hash;
+    CHECK(refs.read(ref, hash) && hash == id("new"));
+}
+
+TEST(refs_update_fails_while_locked) {
+    Refs &refs = Refs::get();
+    const std::string ref = "refs/heads/locked";
+    Files::make_parent_dirs(gitc_path(ref));
+    Files::write_file(gitc_path(ref + ".lock"), "");
+
+    CHECK(!refs.update(ref, id("1"), ObjectId(), "locked"));
+    CHECK(reflog_size(ref) == 0);
+
+    // a lock is never listed as a ref
+    bool listed = false;
+    for (const Refs::Ref &listed_ref: refs.list("refs/heads/")) listed |= listed_ref.name.find(".lock") != std::string::npos;
+    CHECK(!listed);
+
+    Files::delete_file(gitc_path(ref + ".lock"));
+}
+
+TEST(refs_failed_update_takes_back_its_reflog_entry) {
+    // the ref's file can't be replaced by a rename when it's a directory with something in it
+    const std::string ref = "refs/heads/blocked";
+    Files::make_parent_dirs(gitc_path(ref + "/file"));
+    Files::write_file(gitc_path(ref + "/file"), "");
+
+    CHECK(!Refs::get().update(ref, id("1"), ObjectId(), "blocked"));
+    CHECK(reflog_size(ref) == 0);
+
+    Files::delete_file(gitc_path(ref + "/file"));
+    Files::remove_dir(gitc_path(ref));
+}
+
+TEST(refs_pack_moves_loose_refs) {
+    Refs &refs = Refs::get();
+    CHECK(refs.pack() == 102);
+    CHECK(!Files::file_exists(gitc_path("refs/heads/cas")));
+
+    ObjectId hash;
+    CHECK(refs.read("refs/heads/cas", hash) && hash == id("2"));
+    CHECK(refs.read("refs/heads/branch1050", hash) && hash == id("new"));
+    CHECK(refs.list("refs/heads/").size() == 101);
+
+    // the packed file is sorted and has one line per ref
+    std::string content;
+    Files::read_file(gitc_path("packed-refs"), content);
+    CHECK(content.compare(0, 25, "# pack-refs with: sorted\n") == 0);
+    CHECK((size_t) std::count(content.begin(), content.end(), '\n') == 103);
+}
+
+TEST(refs_remove_packed_ref) {
+    Refs &refs = Refs::get();
+    CHECK(refs.remove("refs/heads/cas"));
+
+    ObjectId hash;
+    CHECK(!refs.read("refs/heads/cas", hash));
+    CHECK(reflog_size("refs/heads/cas") == 0);
+    CHECK(refs.read("refs/heads/branch1099", hash));
+    CHECK(refs.list("refs/heads/").size() == 100);
+}
+
+TEST(refs_valid_names) {
+    CHECK(Refs::is_valid_name("main"));
+    CHECK(Refs::is_valid_name("feature/x-1"));
+    CHECK(!Refs::is_valid_name(""));
+    CHECK(!Refs::is_valid_name("-x"));
+    CHECK(!Refs::is_valid_name(".x"));
+    CHECK(!Refs::is_valid_name("a/.x"));
+    CHECK(!Refs::is_valid_name("a..b"));
+    CHECK(!Refs::is_valid_name("a//b"));
+    CHECK(!Refs::is_valid_name("a/"));
+    CHECK(!Refs::is_valid_name("a.lock"));
+    CHECK(!Refs::is_valid_name("a@{1}"));
+    CHECK(!Refs::is_valid_name("a b"));
+    CHECK(!Refs::is_valid_name("a:b"));
+    CHECK(!Refs::is_valid_name(std::string("a\x01", 2)));
+}
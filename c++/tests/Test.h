@@ -0,0 +1,73 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <vector>
+#include <iostream>
+
+#ifndef GIT_CLONE_TEST_H
+#define GIT_CLONE_TEST_H
+
+namespace gitc {
+
+    // a test is a function registered by TEST(name) before main runs, the tests of a file run in the
+    // order they are written. CHECK reports a failed condition and goes on, so one run shows every failure
+    class Test {
+    public:
+        Test(const char *name, void (*body)()) {
+            tests().push_back({name, body});
+        }
+
+        // runs every test and returns the number of failed ones
+        static int run_all() {
+            int failed = 0;
+
+            for (const Registered &test: tests()) {
+                const int failures_before = failures();
+                test.body();
+
+                const bool passed = failures() == failures_before;
+                std::cout << (passed ? "ok    " : "FAIL  ") << test.name << std::endl;
+                if (!passed) failed++;
+            }
+
+            std::cout << tests().size() - failed << " passed, " << failed << " failed" << std::endl;
+            return failed;
+        }
+
+        static bool check(bool passed, const char *expression, const char *file, int line) {
+            if (!passed) {
+                std::cout << file << ":" << line << ": CHECK(" << expression << ") failed" << std::endl;
+                failures()++;
+            }
+            return passed;
+        }
+
+    private:
+        struct Registered {
+            const char *name;
+            void (*body)();
+        };
+
+        static std::vector<Registered> &tests() {
+            static std::vector<Registered> registered;
+            return registered;
+        }
+
+        static int &failures() {
+            static int count = 0;
+            return count;
+        }
+    };
+
+} // gitc
+
+#define TEST(name) \
+    static void name(); \
+    static gitc::Test name##_test(#name, name); \
+    static void name()
+
+#define CHECK(expression) gitc::Test::check((expression), #expression, __FILE__, __LINE__)
+
+#endif //GIT_CLONE_TEST_H
@@ -0,0 +1,51 @@
+//
+// Created on 19-10-2026.
+//
+
+#include <string>
+#include <cstdlib>
+#include <dirent.h>
+#include <unistd.h>
+#include "Test.h"
+#include "../src/Files.h"
+#include "../src/ObjectDatabase.h"
+
+using namespace gitc;
+
+// deletes path and everything below it, .gitc included
+static void remove_recursively(const std::string &path) {
+    if (auto dir = opendir(path.c_str())) {
+        while (auto f = readdir(dir)) {
+            const std::string name = f->d_name;
+            if (name == "." || name == "..") continue;
+
+            if (f->d_type == DT_DIR) {
+                remove_recursively(Files::join_path(path, name));
+            } else {
+                Files::delete_file(Files::join_path(path, name));
+            }
+        }
+        closedir(dir);
+    }
+    Files::remove_dir(path);
+}
+
+// the tests run in a new repository in the temporary directory, with the objects kept in memory
+int main() {
+    const char *temp = std::getenv("TMPDIR");
+    if (temp == nullptr) temp = std::getenv("TEMP");
+
+    const std::string repo = Files::join_path(temp == nullptr ? "/tmp" : temp, "gitc-test-" + Files::create_hash(HASH_LENGTH));
+    Files::make_dir(repo);
+    Files::create_gitc_dir(repo);
+    if (chdir(repo.c_str()) != 0) {
+        std::cout << "fatal: cannot create the test repository " << repo << std::endl;
+        return 1;
+    }
+
+    ObjectDatabase::set(new MemoryObjectDatabase());
+    const int failed = Test::run_all();
+
+    remove_recursively(repo);
+    return failed == 0 ? 0 : 1;
+}